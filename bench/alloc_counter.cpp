@@ -0,0 +1,22 @@
+#include "bench_common.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Linked into the benchmarks that check the audio thread never allocates,
+// see vstfx_benchmark(... COUNT_ALLOCATIONS ...). Replaces the global
+// operator new for the whole program, plugin sources included.
+
+static std::atomic<long> allocations{0};
+
+long BenchAllocations() { return allocations.load(); }
+
+void *operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	void *p = malloc(size ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
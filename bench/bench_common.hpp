@@ -0,0 +1,137 @@
+#ifndef VSTFX_BENCH_COMMON_H
+#define VSTFX_BENCH_COMMON_H
+
+#include "vst.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// -------- Timing --------
+
+class BenchTimer {
+public:
+	void start() { t0 = std::chrono::steady_clock::now(); }
+
+	// elapsed time since start() in microseconds
+	double elapsedUs() const {
+		return std::chrono::duration<double, std::micro>(
+				   std::chrono::steady_clock::now() - t0)
+			.count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point t0;
+};
+
+// -------- Statistics --------
+
+struct BenchStats {
+	double mean{0}, p50{0}, p90{0}, p99{0}, max{0};
+};
+
+inline double BenchPercentile(const std::vector<double> &sorted, double p) {
+	if (sorted.empty()) return 0.0;
+	size_t rank = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[rank];
+}
+
+inline BenchStats BenchSummarize(std::vector<double> samples) {
+	BenchStats s;
+	if (samples.empty()) return s;
+
+	std::sort(samples.begin(), samples.end());
+	for (double v : samples)
+		s.mean += v;
+	s.mean /= samples.size();
+	s.p50 = BenchPercentile(samples, 50);
+	s.p90 = BenchPercentile(samples, 90);
+	s.p99 = BenchPercentile(samples, 99);
+	s.max = samples.back();
+	return s;
+}
+
+inline void BenchPrintStats(const char *name, const char *unit,
+							const BenchStats &s) {
+	printf("%-24s mean %10.2f  p50 %10.2f  p90 %10.2f  p99 %10.2f  max "
+		   "%10.2f %s\n",
+		   name, s.mean, s.p50, s.p90, s.p99, s.max, unit);
+}
+
+// -------- Allocations --------
+
+// operator new calls so far, for benchmarks built with COUNT_ALLOCATIONS
+long BenchAllocations();
+
+// -------- Plugin access --------
+
+extern "C" Vst::AEffect *VSTPluginMain(Vst::AudioMasterCallbackFunc);
+
+// one block worth of events, as the host would hand them over
+struct BenchBatch {
+	Vst::VstMidiEvent midi[Vst::VstEvents::MAX_EVENTS];
+	Vst::VstEvents events;
+
+	BenchBatch() { clear(); }
+
+	void clear() {
+		events.numEvents = 0;
+		events.reserved = 0;
+	}
+
+	int32_t size() const { return events.numEvents; }
+	bool full() const { return size() == Vst::VstEvents::MAX_EVENTS; }
+
+	void add(uint8_t status, uint8_t d1, uint8_t d2, int32_t delta = 0,
+			 int32_t length = 0) {
+		Vst::VstMidiEvent &ev = midi[events.numEvents];
+		memset(&ev, 0, sizeof(ev));
+		ev.type = Vst::kVstMidiType;
+		ev.byteSize = sizeof(ev);
+		ev.deltaFrames = delta;
+		ev.noteLength = length;
+		ev.midiData = status | (d1 << 8) | (d2 << 16);
+		events.events[events.numEvents++] = &ev;
+	}
+
+	// the n-th event onto frame n of a block of `frames`, wrapping
+	void spread(int32_t frames) {
+		for (int32_t i = 0; i < size(); i++)
+			midi[i].deltaFrames = i % frames;
+	}
+
+	void send(Vst::AEffect *effect) {
+		effect->dispatcher(effect, Vst::effProcessEvents, 0, 0, &events,
+						   0.0f);
+	}
+};
+
+// sends a single short MIDI message through effProcessEvents
+inline void BenchSendMidi(Vst::AEffect *effect, uint8_t status, uint8_t d1,
+						  uint8_t d2, int32_t delta_frames = 0) {
+	Vst::VstMidiEvent ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.type = Vst::kVstMidiType;
+	ev.byteSize = sizeof(ev);
+	ev.deltaFrames = delta_frames;
+	ev.midiData = status | (d1 << 8) | (d2 << 16);
+
+	Vst::VstEvents events;
+	events.numEvents = 1;
+	events.reserved = 0;
+	events.events[0] = &ev;
+	effect->dispatcher(effect, Vst::effProcessEvents, 0, 0, &events, 0.0f);
+}
+
+// -------- Fake host --------
+
+// answers every host opcode with "not supported"
+inline intptr_t VSTCALLBACK BenchHostCallback(Vst::AEffect *effect,
+											  Vst::VstOpcodeToHost opcode,
+											  int32_t index, intptr_t value,
+											  void *ptr, float opt) {
+	return 0;
+}
+
+#endif
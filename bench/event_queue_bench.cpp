@@ -0,0 +1,181 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include "util/event_heap.hpp"
+#include <cstdlib>
+
+// Stresses the queue of future events: tens of thousands of pending
+// events straight through the heap, then notes whose noteLength reaches
+// many blocks ahead sent through effProcessEvents. Fails if events come
+// out of order, a queued event misses its frame, a note is left hanging
+// or the audio thread allocates.
+//
+// usage: event_queue_bench [events]
+
+#define RATE 48000.0f
+#define BLOCK 256
+
+typedef VSTFX_EventHeap<VSTFX_PendingEvent, VSTFX_PENDING_EVENTS> Heap;
+
+static uint32_t rng = 12345;
+static uint32_t Random() {
+	rng = rng * 1664525u + 1013904223u;
+	return rng >> 8;
+}
+
+// -------- Heap --------
+
+// random times with plenty of ties, out in time order and first in first
+// out among equal times
+static bool HeapOrder(int32_t count) {
+	static Heap heap; // a megabyte, kept off the stack
+	BenchTimer timer;
+
+	timer.start();
+	bool ok = true;
+	for (int32_t i = 0; i < count; i++) {
+		VSTFX_PendingEvent e = {MIDI_NOTE_OFF, 60, 0, 0, (uint32_t)i};
+		ok &= heap.push(Random() % (count / 4 + 1), e);
+	}
+	double push_ns = 1000.0 * timer.elapsedUs() / count;
+
+	VSTFX_PendingEvent e, prev = {0, 0, 0, 0, 0};
+	int64_t prev_time = -1;
+	int32_t popped = 0;
+	timer.start();
+	for (int64_t t = 0; !heap.empty(); t++) {
+		int64_t due = heap.next();
+		while (heap.pop(t, &e)) {
+			if (due < prev_time) ok = false;
+			if (due == prev_time && e.serial < prev.serial) ok = false;
+			prev_time = due;
+			prev = e;
+			popped++;
+			due = heap.next();
+		}
+	}
+	double pop_ns = 1000.0 * timer.elapsedUs() / count;
+
+	// and refuses what does not fit instead of growing
+	for (size_t i = 0; i < Heap::capacity(); i++)
+		heap.push(0, e);
+	bool refused = !heap.push(0, e);
+	heap.clear();
+
+	printf("heap, %d events       push %7.1f ns  pop %7.1f ns%s\n", count,
+		   push_ns, pop_ns,
+		   ok && popped == count ? "" : "  out of order (FAIL)");
+	if (!refused) printf("full heap took an event (FAIL)\n");
+	return ok && popped == count && refused;
+}
+
+// -------- Plugin --------
+
+static float left[BLOCK], right[BLOCK];
+static float *outputs[2] = {left, right};
+
+// renders `blocks` blocks, returns the first frame with sound or -1
+static int64_t FirstSound(Vst::AEffect *effect, int64_t blocks) {
+	int64_t first = -1;
+	for (int64_t b = 0; b < blocks; b++) {
+		effect->processReplacing(effect, NULL, outputs, BLOCK);
+		for (int32_t i = 0; i < BLOCK && first < 0; i++) {
+			if (left[i] != 0.0f) first = b * BLOCK + i;
+		}
+	}
+	return first;
+}
+
+// the envelope may start from zero on the note's first frame
+static bool OnFrame(const char *what, int64_t frame, int64_t first) {
+	bool ok = first >= frame && first <= frame + 1;
+	printf("%s at frame %lld, first sound at %lld%s\n", what,
+		   (long long)frame, (long long)first, ok ? "" : "  (FAIL)");
+	return ok;
+}
+
+// a note on queued mid block, or sent by the host mid block, starts
+// sounding on its frame, not before
+static bool FrameAccurate(Vst::AEffect *effect) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	const int64_t delay = 3 * BLOCK + 77;
+	VSTFX_PendingEvent on = {MIDI_NOTE_ON, 69, 127, 0, 0};
+	plugin->schedule(plugin->getSampleTime() + delay, on);
+
+	bool ok = OnFrame("scheduled note on", delay, FirstSound(effect, 8));
+	BenchSendMidi(effect, MIDI_NOTE_OFF, 69, 0);
+	FirstSound(effect, 16); // let it fade
+
+	static BenchBatch batch;
+	batch.clear();
+	batch.add(MIDI_NOTE_ON, 69, 127, 77, BLOCK);
+	batch.send(effect);
+	ok &= OnFrame("host note on", 77, FirstSound(effect, 1));
+
+	// its note off counts the length from the frame it started on
+	bool pending = plugin->getPendingEvents() == 1;
+	FirstSound(effect, 1);
+	bool done = plugin->getPendingEvents() == 0;
+	printf("note off after %d frames%s\n", BLOCK,
+		   pending && done ? "" : "  (FAIL)");
+	return ok && pending && done;
+}
+
+// blocks full of notes that say how long they last, up to a few seconds,
+// then rendered until every note off has come
+static bool NoteLengths(Vst::AEffect *effect, int32_t count) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	static BenchBatch batch;
+	const int32_t max_length = (int32_t)(4.0f * RATE);
+
+	const int32_t per_block = Vst::VstEvents::MAX_EVENTS;
+	const int32_t tail = max_length + (int32_t)RATE; // last offs, release
+
+	std::vector<double> block_us;
+	block_us.reserve(count / per_block + tail / BLOCK + 2);
+	size_t max_pending = 0;
+	int32_t sent = 0, rendered = 0;
+	BenchTimer timer;
+
+	long before = BenchAllocations();
+	while (sent < count || rendered * BLOCK < tail) {
+		batch.clear();
+		for (; sent < count && batch.size() < per_block; sent++) {
+			batch.add(MIDI_NOTE_ON, 24 + Random() % 96, 100,
+					  Random() % BLOCK, 1 + Random() % max_length);
+		}
+		if (sent == count) rendered++;
+
+		timer.start();
+		if (batch.size()) batch.send(effect);
+		effect->processReplacing(effect, NULL, outputs, BLOCK);
+		block_us.push_back(timer.elapsedUs());
+		max_pending = std::max(max_pending, plugin->getPendingEvents());
+	}
+	long allocated = BenchAllocations() - before;
+
+	int32_t hanging = plugin->getVoiceEngine()->getActiveVoices();
+	printf("%d notes, up to %zu events pending\n", count, max_pending);
+	BenchPrintStats("block with queue", "us", BenchSummarize(block_us));
+	if (allocated) printf("%ld allocations (FAIL)\n", allocated);
+	if (hanging) printf("%d voices still sounding (FAIL)\n", hanging);
+	return !allocated && !hanging;
+}
+
+int main(int argc, char **argv) {
+	int32_t count = (argc > 1) ? atoi(argv[1]) : 50000;
+	if (count < 1) count = 1;
+	if (count > (int32_t)Heap::capacity()) count = Heap::capacity();
+
+	Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+	effect->dispatcher(effect, Vst::effOpen, 0, 0, NULL, 0.0f);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, RATE);
+	effect->dispatcher(effect, Vst::effMainsChanged, 0, 1, NULL, 0.0f);
+
+	bool ok = HeapOrder(count);
+	ok &= FrameAccurate(effect);
+	ok &= NoteLengths(effect, count);
+
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include "util/arena.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+// Renders several instances at once, one audio thread each, first alone
+// and then with an editor thread per instance automating parameters,
+// editing the mod matrix, arming MIDI learn, draining the scope and
+// polling the meter the whole time. It does so once with the objects in
+// each instance's arena packed back to back, the way plain members sat
+// before, and once with each on lines of its own. With the audio
+// thread's state on lines no other thread writes, the editor threads
+// cost the audio threads nothing but the cores they take.
+//
+// usage: false_sharing_bench [instances] [seconds]
+
+#define RATE 48000.0f
+#define BLOCK 256
+
+struct Instance {
+	Vst::AEffect *effect;
+	std::atomic<int64_t> blocks{0};
+};
+
+static std::atomic<bool> running{false};
+
+static void AudioThread(Instance *inst) {
+	float left[BLOCK], right[BLOCK]; // on the thread's own stack
+	float *outputs[2] = {left, right};
+	while (!running.load(std::memory_order_acquire))
+		std::this_thread::yield();
+
+	int64_t blocks = 0;
+	while (running.load(std::memory_order_relaxed)) {
+		inst->effect->processReplacing(inst->effect, NULL, outputs, BLOCK);
+		blocks++;
+	}
+	inst->blocks.store(blocks, std::memory_order_relaxed);
+}
+
+// what an open editor does as fast as it can: knob drags, mod matrix
+// edits, MIDI learn, parameter reads for the display, the scope and the
+// level meter
+static void EditorThread(Instance *inst) {
+	Vst::AEffect *effect = inst->effect;
+	VSTFX *plugin = (VSTFX *)effect->object;
+	VSTFX_ModMatrix *matrix = plugin->getVoiceEngine()->getMatrix();
+	VSTFX_MidiMap *midi_map = plugin->getMidiMap();
+	VSTFX_AudioTap *tap = plugin->getAudioTap();
+	while (!running.load(std::memory_order_acquire))
+		std::this_thread::yield();
+
+	static thread_local float scope[VSTFX_TAP_CAPACITY];
+	tap->setEnabled(true);
+	float acc = 0.0f;
+	for (int32_t r = 0; running.load(std::memory_order_relaxed); r++) {
+		float value = (r & 0xff) / 255.0f;
+		effect->setParameter(effect, kCutoff, value);
+		effect->setParameter(effect, kVolume, 0.5f + 0.25f * value);
+		VSTFX_ModSlot slot = {VSTFX_MOD_SRC_LFO, VSTFX_MOD_DST_CUTOFF,
+							  0.25f * value, false};
+		matrix->setSlot(0, slot);
+		midi_map->learn((r & 1) ? kCutoff : -1);
+		midi_map->forget(kResonance);
+		acc += tap->drain(scope, VSTFX_TAP_CAPACITY);
+		for (int32_t i = 0; i < PARAMETER_COUNT; i++)
+			acc += effect->getParameter(effect, i);
+		acc += (float)effect->dispatcher(effect, Vst::effGetVu, 0, 0, NULL,
+										 0.0f);
+	}
+	tap->setEnabled(false);
+	if (acc < 0.0f) printf(" ");
+}
+
+// blocks per second of each instance's audio thread
+static std::vector<double> Run(std::vector<Instance> &instances,
+							   bool editors, double seconds) {
+	std::vector<std::thread> threads;
+	for (Instance &inst : instances) {
+		threads.emplace_back(AudioThread, &inst);
+		if (editors) threads.emplace_back(EditorThread, &inst);
+	}
+
+	running.store(true, std::memory_order_release);
+	std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	running.store(false, std::memory_order_relaxed);
+	for (std::thread &t : threads)
+		t.join();
+
+	std::vector<double> rates;
+	for (Instance &inst : instances)
+		rates.push_back(inst.blocks.load() / seconds);
+	return rates;
+}
+
+// slowdown of the audio threads once the editors run, for instances
+// created with the arena packed or not
+static double Layout(int count, double seconds, bool packed) {
+	VSTFX_Arena::SetPacked(packed);
+	std::vector<Instance> instances(count);
+	for (Instance &inst : instances) {
+		inst.effect = VSTPluginMain(BenchHostCallback);
+		Vst::AEffect *effect = inst.effect;
+		effect->dispatcher(effect, Vst::effOpen, 0, 0, NULL, 0.0f);
+		effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, RATE);
+		effect->dispatcher(effect, Vst::effMainsChanged, 0, 1, NULL, 0.0f);
+		// a held chord, so the voices have work to do
+		for (int32_t n = 0; n < 4; n++)
+			BenchSendMidi(effect, MIDI_NOTE_ON, 48 + 7 * n, 100);
+	}
+	VSTFX_Arena::SetPacked(false);
+
+	printf("-- %s\n", packed ? "packed, as plain members" : "arena lines");
+	BenchStats alone = BenchSummarize(Run(instances, false, seconds));
+	BenchStats edited = BenchSummarize(Run(instances, true, seconds));
+	BenchPrintStats("audio alone", "blocks/s", alone);
+	BenchPrintStats("audio + editors", "blocks/s", edited);
+
+	double slowdown = alone.mean > 0.0 ? 1.0 - edited.mean / alone.mean : 0.0;
+	printf("slowdown with editors %.1f%%\n", 100.0 * slowdown);
+
+	for (Instance &inst : instances)
+		inst.effect->dispatcher(inst.effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return slowdown;
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 4;
+	double seconds = (argc > 2) ? atof(argv[2]) : 2.0;
+	unsigned cores = std::thread::hardware_concurrency();
+
+	printf("%d instances, %.1f s each run, %u cores\n", count, seconds,
+		   cores);
+	double packed = Layout(count, seconds, true);
+	double lines = Layout(count, seconds, false);
+	printf("slowdown packed %.1f%%, on lines %.1f%%\n", 100.0 * packed,
+		   100.0 * lines);
+
+	// with fewer cores than threads the editors take turns with the audio
+	// threads, and the slowdown says nothing about the memory layout
+	bool measured = cores >= 2u * count;
+	if (!measured) printf("fewer cores than threads, not judged\n");
+	bool failed = measured && lines > 0.2;
+	if (failed) printf("editor threads slow down the audio (FAIL)\n");
+	return failed ? 1 : 0;
+}
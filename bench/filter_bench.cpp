@@ -0,0 +1,115 @@
+#include "bench_common.hpp"
+#include "dsp/voice.hpp"
+#include <cmath>
+#include <cstdlib>
+
+// Cost of the voice filter per voice, for both models, as polyphony grows.
+// Stereo voices are filtered VSTFX_FILTER_LANES at a time, so the cost per
+// voice should drop until the lanes are full and stay flat after that.
+//
+// usage: filter_bench [blocks]
+
+#define FRAMES 256
+
+static double Run(int voices, VSTFX_FilterType type, int blocks) {
+	// a fresh engine, so no voices linger from the previous run
+	VSTFX_VoiceEngine *engine = new VSTFX_VoiceEngine();
+	engine->setSampleRate(48000.0f);
+	for (int i = 0; i < voices; i++)
+		engine->noteOn(36 + i * 2, 100);
+
+	static float lfo[FRAMES], left[FRAMES], right[FRAMES];
+	for (int i = 0; i < FRAMES; i++)
+		lfo[i] = sinf(i * 0.05f);
+
+	// sweep the cutoff so coefficients change every block
+	VSTFX_VoiceContext ctx = {lfo, 0.0f, 0.0f, VSTFX_WAVE_SINE,
+							   type, 5.0f, 0.5f};
+
+	BenchTimer timer;
+	double best = 1e30;
+	for (int trial = 0; trial < 25; trial++) {
+		timer.start();
+		for (int i = 0; i < blocks; i++) {
+			ctx.cutoff = 4.0f + 4.0f * ((i & 63) / 64.0f);
+			engine->render(left, right, FRAMES, ctx);
+		}
+		best = std::min(best, timer.elapsedUs());
+	}
+
+	delete engine;
+	return best / blocks;
+}
+
+// the filter alone, on lanes of noise, the way the engine calls it
+static double RunFilter(int voices, VSTFX_FilterType type, int blocks) {
+	VSTFX_VoiceFilter filter;
+	filter.setSampleRate(48000.0f);
+
+	int groups = (voices + VSTFX_FILTER_LANES - 1) / VSTFX_FILTER_LANES;
+	static VSTFX_FilterState states[VSTFX_MAX_VOICES];
+	VSTFX_FilterState *lanes_of[VSTFX_MAX_VOICES];
+	for (int i = 0; i < VSTFX_MAX_VOICES; i++) {
+		states[i].reset();
+		lanes_of[i] = &states[i];
+	}
+
+	static float lanes[VSTFX_VOICE_CHUNK * VSTFX_FILTER_FRAME];
+	float cutoff[VSTFX_VOICE_SUBBLOCKS * VSTFX_FILTER_LANES];
+
+	BenchTimer timer;
+	double best = 1e30;
+	for (int trial = 0; trial < 25; trial++) {
+		timer.start();
+		for (int i = 0; i < blocks * FRAMES / VSTFX_VOICE_CHUNK; i++) {
+			for (int j = 0; j < VSTFX_VOICE_SUBBLOCKS * VSTFX_FILTER_LANES;
+				 j++)
+				cutoff[j] = 4.0f + 4.0f * (((i + j) & 63) / 64.0f);
+			for (int j = 0; j < VSTFX_VOICE_CHUNK * VSTFX_FILTER_FRAME; j++)
+				lanes[j] = (float)((j * 7919) % 200) / 100.0f - 1.0f;
+
+			for (int g = 0; g < groups; g++) {
+				filter.process(type, lanes_of + g * VSTFX_FILTER_LANES,
+							   lanes, VSTFX_VOICE_CHUNK, VSTFX_MOD_BLOCK,
+							   cutoff, 0.5f);
+			}
+		}
+		best = std::min(best, timer.elapsedUs());
+	}
+	return best / blocks;
+}
+
+int main(int argc, char **argv) {
+	int blocks = (argc > 1) ? atoi(argv[1]) : 400;
+	const int counts[] = {1, 4, 8, 12, 16};
+	const char *names[] = {"", "SVF", "Ladder"};
+
+	printf("%d frames per block, %d lanes, ns per stereo voice and sample\n",
+		   FRAMES, VSTFX_FILTER_LANES);
+
+	printf("-- filter only\n");
+	for (int voices : counts) {
+		double scale = 1000.0 / ((double)voices * FRAMES);
+		printf("%2d voices: SVF %6.2f, Ladder %6.2f\n", voices,
+			   RunFilter(voices, VSTFX_FILTER_SVF, blocks) * scale,
+			   RunFilter(voices, VSTFX_FILTER_LADDER, blocks) * scale);
+	}
+
+	printf("-- whole voice engine\n");
+
+	Run(VSTFX_MAX_VOICES, VSTFX_FILTER_LADDER, blocks / 10); // warm up
+	for (int voices : counts) {
+		double off = Run(voices, VSTFX_FILTER_OFF, blocks);
+		double scale = 1000.0 / ((double)voices * FRAMES);
+		printf("%2d voices: unfiltered %6.2f", voices, off * scale);
+
+		for (int type = VSTFX_FILTER_SVF; type <= VSTFX_FILTER_LADDER;
+			 type++) {
+			double us = Run(voices, (VSTFX_FilterType)type, blocks);
+			printf(", %s %6.2f (filter %5.2f)", names[type], us * scale,
+				   (us - off) * scale);
+		}
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,146 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "gui/gui.hpp"
+#include "SDL.h"
+#include <cstdlib>
+
+// Renders the editor into a hidden window with SDL's software renderer while
+// dragging the mouse over the knobs, then reports per-frame cost. The knobs
+// are found where the editor laid them out, and the run fails if a drag
+// leaves its parameter untouched, so the frames measured are interaction.
+//
+// usage: gui_frame_bench [frames] [width] [height]
+
+static void PushMouse(SDL_Window *window, Uint32 type, int x, int y) {
+	SDL_Event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.type = type;
+	if (type == SDL_MOUSEMOTION) {
+		ev.motion.windowID = SDL_GetWindowID(window);
+		ev.motion.x = x;
+		ev.motion.y = y;
+	} else {
+		ev.button.windowID = SDL_GetWindowID(window);
+		ev.button.button = SDL_BUTTON_LEFT;
+		ev.button.state =
+			(type == SDL_MOUSEBUTTONDOWN) ? SDL_PRESSED : SDL_RELEASED;
+		ev.button.clicks = 1;
+		ev.button.x = x;
+		ev.button.y = y;
+	}
+	SDL_PushEvent(&ev);
+}
+
+#define GESTURE_FRAMES 48
+#define DRAGGED_KNOBS 4
+
+// the knob being dragged and whether its parameter has moved yet
+struct Gesture {
+	int32_t param{-1};
+	float x{0.0f}, y{0.0f};
+	float start{0.0f};
+	bool moved{false};
+};
+
+// one drag gesture every GESTURE_FRAMES frames: press on a knob, drag up
+// and down, release -- taking turns between the first few knobs, wherever
+// the last frame put them
+static void DriveMouse(VSTFX_GUI &gui, VSTFX &plugin, int frame,
+					   Gesture *g) {
+	int step = frame % GESTURE_FRAMES;
+	if (step == 0) {
+		*g = Gesture();
+		int32_t param = (frame / GESTURE_FRAMES) % DRAGGED_KNOBS;
+		if (!gui.getKnobCenter(param, &g->x, &g->y)) return;
+		g->param = param;
+		g->start = plugin.getParameter(param);
+	}
+	if (g->param < 0) return;
+
+	int x = (int)g->x, y = (int)g->y;
+	if (step == 0) {
+		PushMouse(gui.getWindow(), SDL_MOUSEMOTION, x, y);
+		PushMouse(gui.getWindow(), SDL_MOUSEBUTTONDOWN, x, y);
+	} else if (step < 40) {
+		int dy = (step < 20) ? -step : step - 40;
+		PushMouse(gui.getWindow(), SDL_MOUSEMOTION, x, y + dy * 3);
+	} else if (step == 40) {
+		PushMouse(gui.getWindow(), SDL_MOUSEBUTTONUP, x, y);
+	}
+}
+
+int main(int argc, char **argv) {
+	int frames = (argc > 1) ? atoi(argv[1]) : 600;
+	int width = (argc > 2) ? atoi(argv[2]) : 500;
+	int height = (argc > 3) ? atoi(argv[3]) : 500;
+
+	VSTFX plugin(BenchHostCallback);
+	VSTFX_GUI gui(&plugin);
+
+	// prefer the offscreen driver, the dummy one is available everywhere
+	BenchTimer open_timer;
+	open_timer.start();
+	SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+	if (!gui.openOffscreen(width, height)) {
+		SDL_VideoQuit();
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		if (!gui.openOffscreen(width, height)) {
+			fprintf(stderr, "unable to open an offscreen editor\n");
+			return 1;
+		}
+	}
+	printf("video driver: %s, %dx%d, %d frames\n", SDL_GetCurrentVideoDriver(),
+		   width, height, frames);
+
+	// editor open includes the first frame, which uploads the textures
+	gui.idle();
+	printf("editor open + first frame: %.2f ms\n",
+		   open_timer.elapsedUs() / 1000.0);
+
+	for (int i = 0; i < 4; i++)
+		gui.idle();
+
+	std::vector<double> frame_us, vtx, idx, cmds;
+	frame_us.reserve(frames);
+	vtx.reserve(frames);
+	idx.reserve(frames);
+	cmds.reserve(frames);
+
+	BenchTimer timer;
+	Gesture gesture;
+	int gestures = 0, missed = 0;
+	for (int i = 0; i < frames; i++) {
+		DriveMouse(gui, plugin, i, &gesture);
+
+		timer.start();
+		gui.idle();
+		frame_us.push_back(timer.elapsedUs());
+
+		if (gesture.param >= 0 &&
+			plugin.getParameter(gesture.param) != gesture.start)
+			gesture.moved = true;
+		// a gesture cut short by the last frame counts once it was released
+		int step = i % GESTURE_FRAMES;
+		if (step == GESTURE_FRAMES - 1 || (i == frames - 1 && step >= 40)) {
+			gestures++;
+			missed += !gesture.moved;
+		}
+
+		// draw data stays valid until the next frame starts
+		ImDrawData *dd = ImGui::GetDrawData();
+		int n_cmds = 0;
+		for (int l = 0; l < dd->CmdListsCount; l++)
+			n_cmds += dd->CmdLists[l]->CmdBuffer.Size;
+		vtx.push_back(dd->TotalVtxCount);
+		idx.push_back(dd->TotalIdxCount);
+		cmds.push_back(n_cmds);
+	}
+
+	BenchPrintStats("frame time", "us", BenchSummarize(frame_us));
+	BenchPrintStats("vertices/frame", "", BenchSummarize(vtx));
+	BenchPrintStats("indices/frame", "", BenchSummarize(idx));
+	BenchPrintStats("draw commands/frame", "", BenchSummarize(cmds));
+	printf("%d drags, %d left their knob untouched%s\n", gestures, missed,
+		   missed ? "  (FAIL)" : "");
+	return missed ? 1 : 0;
+}
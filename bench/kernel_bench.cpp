@@ -0,0 +1,296 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "dsp/meter.hpp"
+#include "dsp/voice.hpp"
+#include "midi.hpp"
+#include "util/trace.hpp"
+#include <cstdlib>
+#include <string>
+
+// Times the hot kernels one at a time, writes the results as JSON and
+// compares them with a baseline, so a slowdown shows up under the name of
+// the kernel that got slower rather than in the total.
+//
+// usage: kernel_bench [--json out.json] [--baseline in.json]
+//                     [--tolerance 0.25] [--filter substring]
+//
+// Exits with 1 when a kernel is slower than its baseline by more than the
+// tolerance. Baselines only compare on the machine that wrote them.
+
+#define RATE 48000.0f
+#define BLOCK 256
+
+// keeps results alive without the optimizer seeing through them
+static volatile float sink;
+
+// -------- Kernels --------
+
+struct Kernel {
+	const char *name;
+	const char *unit; // what one timed item is
+	double ns;		  // per item, best of the trials
+};
+
+static std::vector<Kernel> results;
+static const char *filter = NULL;
+
+// `run` does `items` items once, the best of several trials is kept
+template <typename Fn>
+static void Measure(const char *name, const char *unit, double items, Fn run) {
+	if (filter && !strstr(name, filter)) return;
+
+	BenchTimer timer;
+	double best = 1e30;
+	run(); // warm up
+	for (int trial = 0; trial < 7; trial++) {
+		timer.start();
+		run();
+		best = std::min(best, timer.elapsedUs());
+	}
+	results.push_back({name, unit, 1000.0 * best / items});
+}
+
+// the unison oscillator loop every voice runs per sample
+static void Oscillators() {
+	const int samples = 1 << 16;
+	struct Case {
+		const char *name;
+		VSTFX_Waveform wave;
+		int32_t unison;
+	} cases[] = {{"osc.sine", VSTFX_WAVE_SINE, 1},
+				 {"osc.saw", VSTFX_WAVE_SAW, 1},
+				 {"osc.saw.unison16", VSTFX_WAVE_SAW, 16}};
+
+	for (const Case &c : cases) {
+		VSTFX_UnisonOsc osc;
+		osc.start(440.0f / RATE, c.unison, 0.5f, 0.5f, 1);
+		Measure(c.name, "sample", samples, [&] {
+			float acc = 0.0f;
+			for (int i = 0; i < samples; i++) {
+				float l, r;
+				osc.next(c.wave, 1.0f, &l, &r);
+				acc += l + r;
+			}
+			sink = acc;
+		});
+	}
+}
+
+// release envelope and note off fade
+static void Envelope() {
+	const int samples = 1 << 16;
+	VSTFX_Voice v;
+	v.released = true;
+	Measure("envelope", "sample", samples, [&] {
+		v.env = VSTFX_VOICE_LEVEL;
+		v.fade = 1.0f;
+		float acc = 0.0f;
+		for (int i = 0; i < samples; i++)
+			acc += v.envelope(1e-6f, 1e-6f);
+		sink = acc;
+	});
+}
+
+// effProcessEvents, per event
+static void Events(Vst::AEffect *effect) {
+	const int batches = 200;
+	static BenchBatch notes, controllers;
+	for (int32_t i = 0; !notes.full(); i++) {
+		notes.add(MIDI_NOTE_ON, 36 + i % 48, 100);
+		notes.add(MIDI_NOTE_OFF, 36 + i % 48, 0);
+	}
+	for (int32_t i = 0; !controllers.full(); i++)
+		controllers.add(MIDI_CC | (i % 16), (i * 13) & 0x7f, i & 0x7f);
+	notes.spread(BLOCK);
+	controllers.spread(BLOCK);
+
+	Measure("events.notes", "event", (double)batches * notes.size(), [&] {
+		for (int i = 0; i < batches; i++)
+			notes.send(effect);
+	});
+	Measure("events.cc", "event", (double)batches * controllers.size(), [&] {
+		for (int i = 0; i < batches; i++)
+			controllers.send(effect);
+	});
+}
+
+// host automation through the AEffect entry points, per call
+static void Parameters(Vst::AEffect *effect) {
+	const int rounds = 20000;
+	const double calls = (double)rounds * PARAMETER_COUNT;
+
+	Measure("param.set", "call", calls, [&] {
+		for (int r = 0; r < rounds; r++) {
+			float value = (r & 0xff) / 255.0f;
+			for (int32_t i = 0; i < PARAMETER_COUNT; i++)
+				effect->setParameter(effect, i, value);
+		}
+	});
+	Measure("param.get", "call", calls, [&] {
+		float acc = 0.0f;
+		for (int r = 0; r < rounds; r++) {
+			for (int32_t i = 0; i < PARAMETER_COUNT; i++)
+				acc += effect->getParameter(effect, i);
+		}
+		sink = acc;
+	});
+}
+
+// processReplacing with no voices: smoothing, tremolo, delay, meter and
+// scope tap, per frame, for each output layout
+static void Output(Vst::AEffect *effect) {
+	const int blocks = 200;
+	static float buffers[VSTFX_MULTI_OUTPUTS][BLOCK];
+	float *outputs[VSTFX_MULTI_OUTPUTS];
+	for (int32_t c = 0; c < VSTFX_MULTI_OUTPUTS; c++)
+		outputs[c] = buffers[c];
+
+	struct Case {
+		const char *name;
+		int32_t channels;
+	} cases[] = {{"output.block", 2},
+				 {"output.block.mono", 1},
+				 {"output.block.multi", VSTFX_MULTI_OUTPUTS}};
+
+	for (const Case &c : cases) {
+		Vst::VstSpeakerArrangement arrangement{};
+		arrangement.numChannels = c.channels;
+		effect->dispatcher(effect, Vst::effSetSpeakerArrangement, 0, 0,
+						   &arrangement, 0.0f);
+		Measure(c.name, "frame", (double)blocks * BLOCK, [&] {
+			for (int i = 0; i < blocks; i++)
+				effect->processReplacing(effect, NULL, outputs, BLOCK);
+		});
+	}
+
+	VSTFX_Meter meter;
+	Measure("output.meter", "frame", (double)blocks * BLOCK, [&] {
+		for (int i = 0; i < blocks; i++)
+			meter.process(outputs, 2, BLOCK);
+	});
+}
+
+// a span while tracing is off, what every traced call pays
+static void Tracing() {
+	const int spans = 1 << 20;
+	Measure("trace.span.off", "span", spans, [&] {
+		for (int i = 0; i < spans; i++) {
+			VSTFX_TraceSpan span("bench", "span", "i", i);
+		}
+	});
+}
+
+// -------- JSON --------
+
+static bool WriteJson(const char *path) {
+	FILE *f = fopen(path, "w");
+	if (!f) return false;
+	fprintf(f, "{\n  \"unit\": \"ns\",\n  \"kernels\": {\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		fprintf(f, "    \"%s\": %.3f%s\n", results[i].name, results[i].ns,
+				i + 1 < results.size() ? "," : "");
+	}
+	fprintf(f, "  }\n}\n");
+	fclose(f);
+	return true;
+}
+
+// the "name": number pairs of a file WriteJson() wrote
+static bool ReadJson(const char *path,
+					 std::vector<std::pair<std::string, double>> *out) {
+	FILE *f = fopen(path, "r");
+	if (!f) return false;
+	std::string text;
+	char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		text.append(buf, n);
+	fclose(f);
+
+	size_t pos = text.find("\"kernels\"");
+	if (pos == std::string::npos) return false;
+	pos = text.find('{', pos);
+
+	while ((pos = text.find('"', pos)) != std::string::npos) {
+		size_t end = text.find('"', pos + 1);
+		if (end == std::string::npos) break;
+		std::string name = text.substr(pos + 1, end - pos - 1);
+
+		const char *p = text.c_str() + end + 1;
+		while (*p == ' ' || *p == ':')
+			p++;
+		char *after;
+		double value = strtod(p, &after);
+		if (after != p) out->push_back({name, value});
+		pos = after - text.c_str();
+	}
+	return true;
+}
+
+// -------- Main --------
+
+int main(int argc, char **argv) {
+	const char *json = NULL, *baseline = NULL;
+	double tolerance = 0.25;
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 == argc) {
+			fprintf(stderr, "%s needs a value\n", argv[i]);
+			return 2;
+		} else if (!strcmp(argv[i], "--json")) {
+			json = argv[i + 1];
+		} else if (!strcmp(argv[i], "--baseline")) {
+			baseline = argv[i + 1];
+		} else if (!strcmp(argv[i], "--tolerance")) {
+			tolerance = atof(argv[i + 1]);
+		} else if (!strcmp(argv[i], "--filter")) {
+			filter = argv[i + 1];
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, RATE);
+
+	Oscillators();
+	Envelope();
+	Events(effect);
+	Parameters(effect);
+	Output(effect);
+	Tracing();
+
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+
+	if (json && !WriteJson(json)) {
+		fprintf(stderr, "cannot write %s\n", json);
+		return 2;
+	}
+
+	std::vector<std::pair<std::string, double>> base;
+	if (baseline && !ReadJson(baseline, &base)) {
+		fprintf(stderr, "cannot read %s\n", baseline);
+		return 2;
+	}
+
+	bool failed = false;
+	for (const Kernel &k : results) {
+		double ref = 0.0;
+		for (const auto &b : base) {
+			if (b.first == k.name) ref = b.second;
+		}
+
+		printf("%-20s %9.3f ns/%-6s", k.name, k.ns, k.unit);
+		if (ref > 0.0) {
+			double change = k.ns / ref - 1.0;
+			bool slower = change > tolerance;
+			printf("  baseline %9.3f  %+6.1f%%%s", ref, 100.0 * change,
+				   slower ? "  (REGRESSION)" : "");
+			failed |= slower;
+		} else if (baseline) {
+			printf("  (not in baseline)");
+		}
+		printf("\n");
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "gui/gui.hpp"
+#include "SDL.h"
+#include <cstdlib>
+
+// Draws a large control surface of knobs with both the procedural and the
+// cached filmstrip renderer and compares their per-frame cost.
+//
+// usage: knob_bench [knobs] [frames]
+
+class KnobStressGUI : public VSTFX_GUI {
+public:
+	KnobStressGUI(VSTFX *e, int knobs) : VSTFX_GUI(e), values(knobs) {}
+
+	int frame{0};
+
+protected:
+	std::vector<float> values;
+
+	void RenderGUI() override {
+		ImGuiIO &io = ImGui::GetIO();
+		ImGui::SetNextWindowSize(io.DisplaySize);
+		ImGui::SetNextWindowPos(ImVec2(0, 0));
+		ImGui::Begin("Knobs", NULL,
+					 ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize);
+
+		int per_row = (int)(io.DisplaySize.x / 48);
+		char label[16];
+		for (size_t i = 0; i < values.size(); i++) {
+			// sweep every knob so the cached path changes frames too
+			values[i] = (float)((frame + i * 7) % 128) / 127.0f;
+			snprintf(label, sizeof(label), "K%d", (int)i);
+			Knob(label, &values[i], 0.0f, 1.0f);
+			if ((int)(i + 1) % per_row != 0) ImGui::SameLine();
+		}
+
+		ImGui::End();
+		frame++;
+	}
+};
+
+static void RunStyle(KnobStressGUI &gui, VSTFX_KnobStyle style,
+					 const char *name, int frames) {
+	gui.setKnobStyle(style);
+
+	// warm up, this also builds the filmstrip on the cached path
+	for (int i = 0; i < 4; i++)
+		gui.idle();
+
+	std::vector<double> frame_us, vtx, cmds;
+	BenchTimer timer;
+	for (int i = 0; i < frames; i++) {
+		timer.start();
+		gui.idle();
+		frame_us.push_back(timer.elapsedUs());
+
+		ImDrawData *dd = ImGui::GetDrawData();
+		int n_cmds = 0;
+		for (int l = 0; l < dd->CmdListsCount; l++)
+			n_cmds += dd->CmdLists[l]->CmdBuffer.Size;
+		vtx.push_back(dd->TotalVtxCount);
+		cmds.push_back(n_cmds);
+	}
+
+	printf("-- %s\n", name);
+	BenchPrintStats("frame time", "us", BenchSummarize(frame_us));
+	BenchPrintStats("vertices/frame", "", BenchSummarize(vtx));
+	BenchPrintStats("draw commands/frame", "", BenchSummarize(cmds));
+}
+
+int main(int argc, char **argv) {
+	int knobs = (argc > 1) ? atoi(argv[1]) : 500;
+	int frames = (argc > 2) ? atoi(argv[2]) : 300;
+
+	// 25 knobs per row, enough rows for everything to stay on screen
+	int width = 25 * 48 + 16;
+	int height = ((knobs + 24) / 25) * 72 + 16;
+
+	VSTFX plugin(BenchHostCallback);
+	KnobStressGUI gui(&plugin, knobs);
+
+	SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+	if (!gui.openOffscreen(width, height)) {
+		SDL_VideoQuit();
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		if (!gui.openOffscreen(width, height)) {
+			fprintf(stderr, "unable to open an offscreen editor\n");
+			return 1;
+		}
+	}
+	printf("%d knobs, %dx%d, %d frames\n", knobs, width, height, frames);
+
+	RunStyle(gui, VSTFX_KNOB_PROCEDURAL, "procedural", frames);
+	RunStyle(gui, VSTFX_KNOB_CACHED, "cached filmstrip", frames);
+	return 0;
+}
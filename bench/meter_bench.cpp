@@ -0,0 +1,88 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include <cstdlib>
+
+// Compares the cost of the output meter against the rest of
+// processReplacing, for silent and for sounding output, down to the
+// smallest blocks hosts send. Fails if the median overhead of a block size
+// goes over the budget by more than the spread between its trials.
+//
+// usage: meter_bench [blocks]
+
+#define BUDGET_PERCENT 5.0
+#define TRIALS 9
+
+// one trial times the whole render and the meter alone over the same blocks,
+// best of a few runs each, so scheduler noise does not count against either
+static double MeasureOverhead(Vst::AEffect *effect, float **outputs,
+							  int32_t frames, int blocks, double *render_us,
+							  double *meter_us) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	BenchTimer timer;
+	*render_us = 1e30;
+	*meter_us = 1e30;
+
+	for (int run = 0; run < 4; run++) {
+		timer.start();
+		for (int i = 0; i < blocks; i++)
+			effect->processReplacing(effect, NULL, outputs, frames);
+		*render_us = std::min(*render_us, timer.elapsedUs());
+
+		timer.start();
+		for (int i = 0; i < blocks; i++)
+			plugin->getMeter()->process(outputs, 2, frames);
+		*meter_us = std::min(*meter_us, timer.elapsedUs());
+	}
+	return 100.0 * *meter_us / (*render_us - *meter_us);
+}
+
+int main(int argc, char **argv) {
+	int blocks = (argc > 1) ? atoi(argv[1]) : 2000;
+	const int32_t sizes[] = {32, 64, 256, 1024};
+
+	Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, 48000.0f);
+
+	std::vector<float> left(1024), right(1024);
+	float *outputs[2] = {left.data(), right.data()};
+
+	int over_budget = 0;
+	for (int sounding = 0; sounding < 2; sounding++) {
+		if (sounding) BenchSendMidi(effect, MIDI_NOTE_ON, 60, 100);
+		printf("-- %s output\n", sounding ? "sounding" : "silent");
+
+		for (int32_t frames : sizes) {
+			double render_us, meter_us;
+			MeasureOverhead(effect, outputs, frames, blocks / 10, &render_us,
+							&meter_us); // warm up
+
+			std::vector<double> percents, renders, meters;
+			for (int trial = 0; trial < TRIALS; trial++) {
+				percents.push_back(MeasureOverhead(
+					effect, outputs, frames, blocks, &render_us, &meter_us));
+				renders.push_back(render_us);
+				meters.push_back(meter_us);
+			}
+			std::sort(percents.begin(), percents.end());
+			double median = BenchPercentile(percents, 50);
+			double spread = percents.back() - percents.front();
+
+			// only a median above the budget by more than the trials
+			// disagree with each other is a real overrun
+			bool over = median > BUDGET_PERCENT + spread;
+			over_budget += over;
+			printf("%5d frames: render %8.3f us/block, meter %7.3f us/block, "
+				   "overhead %5.2f%% (spread %4.2f)%s\n",
+				   (int)frames, BenchSummarize(renders).p50 / blocks,
+				   BenchSummarize(meters).p50 / blocks, median, spread,
+				   over ? "  (over budget)" : "");
+		}
+	}
+
+	printf("%d of %d configurations over the %.0f%% budget\n", over_budget,
+		   (int)(2 * sizeof(sizes) / sizeof(sizes[0])), BUDGET_PERCENT);
+
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return over_budget ? 1 : 0;
+}
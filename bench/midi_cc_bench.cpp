@@ -0,0 +1,99 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include <cstdlib>
+
+// Floods effProcessEvents with controller traffic like a dense hardware
+// surface would send, and reports the cost per message. Heap allocations
+// during the timed runs are counted and make the benchmark fail.
+//
+// usage: midi_cc_bench [blocks]
+
+// -------- Traffic --------
+
+// 14-bit sweep of CC 1/33, the mapped gain
+static void Fill14Bit(BenchBatch *b) {
+	for (int32_t v = 0; !b->full(); v += 37) {
+		b->add(MIDI_CC, MIDI_CC_MODWHEEL, (v >> 7) & 0x7f);
+		b->add(MIDI_CC, MIDI_CC_MODWHEEL + MIDI_CC_LSB_OFFSET, v & 0x7f);
+	}
+}
+
+// NRPN 1:2 on channel 2, the mapped release, with full select each time
+static void FillNrpn(BenchBatch *b) {
+	for (int32_t v = 0; !b->full(); v += 101) {
+		b->add(MIDI_CC | 1, MIDI_CC_NRPN_H, 1);
+		b->add(MIDI_CC | 1, MIDI_CC_NRPN_L, 2);
+		b->add(MIDI_CC | 1, MIDI_CC_DATA_ENTRY_H, (v >> 7) & 0x7f);
+		b->add(MIDI_CC | 1, MIDI_CC_DATA_ENTRY_L, v & 0x7f);
+	}
+}
+
+// every controller on every channel, nearly all of them unmapped
+static void FillSurface(BenchBatch *b) {
+	for (int32_t i = 0; !b->full(); i++) {
+		int32_t ch = i % 16;
+		if (i % 7 == 0) {
+			b->add(MIDI_PITCH_BEND | ch, i & 0x7f, (i >> 3) & 0x7f);
+		} else {
+			b->add(MIDI_CC | ch, (i * 13) & 0x7f, i & 0x7f);
+		}
+	}
+}
+
+static double Run(Vst::AEffect *effect, BenchBatch *b, int blocks) {
+	BenchTimer timer;
+	double best = 1e30;
+
+	for (int trial = 0; trial < 5; trial++) {
+		timer.start();
+		for (int i = 0; i < blocks; i++)
+			b->send(effect);
+		best = std::min(best, timer.elapsedUs());
+	}
+	return best;
+}
+
+int main(int argc, char **argv) {
+	int blocks = (argc > 1) ? atoi(argv[1]) : 20000;
+
+	Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, 48000.0f);
+
+	VSTFX *plugin = (VSTFX *)effect->object;
+	VSTFX_MidiMap *map = plugin->getMidiMap();
+	map->mapCC(0, MIDI_CC_MODWHEEL, kVolume);
+	map->mapNrpn(1, (1 << 7) | 2, kRelease);
+
+	static BenchBatch batches[3];
+	Fill14Bit(&batches[0]);
+	FillNrpn(&batches[1]);
+	FillSurface(&batches[2]);
+	for (BenchBatch &b : batches)
+		b.spread(64);
+	const char *names[3] = {"14-bit CC pairs", "NRPN data entry",
+							"surface, 16 channels"};
+
+	bool failed = false;
+	for (int i = 0; i < 3; i++) {
+		Run(effect, &batches[i], blocks / 10); // warm up
+
+		long before = BenchAllocations();
+		double us = Run(effect, &batches[i], blocks);
+		long allocated = BenchAllocations() - before;
+
+		double messages = (double)blocks * batches[i].size();
+		printf("%-22s %7.2f ns/message, %6.1f M messages/s, %ld "
+			   "allocations%s\n",
+			   names[i], 1000.0 * us / messages, messages / us, allocated,
+			   allocated ? "  (FAIL)" : "");
+		failed |= allocated != 0;
+	}
+
+	// the last pair of each stream decides the value
+	printf("gain %.4f, release %.4f after the streams\n",
+		   plugin->getParameter(kVolume), plugin->getParameter(kRelease));
+
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return failed ? 1 : 0;
+}
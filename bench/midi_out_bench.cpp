@@ -0,0 +1,187 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include <cstdlib>
+
+// Sends MIDI from the plugin the ways it can: controller feedback for an
+// automated parameter, generated notes queued for later blocks, and more
+// messages than a block can hold. Reports the cost of a block sending
+// all it can and how many messages were dropped, and fails if a block
+// calls the host more than once, hands over events out of frame order,
+// echoes a controller's own value back to it, drops messages without
+// counting them, or the audio thread allocates.
+//
+// usage: midi_out_bench [blocks]
+
+#define RATE 48000.0f
+#define BLOCK 256
+#define CUTOFF_CC 74
+
+// -------- Host --------
+
+// what the host received during the current block
+static struct {
+	int32_t calls;
+	int32_t events;
+	int32_t notes;
+	int32_t controllers; // CUTOFF_CC only
+	bool ordered;
+} got;
+
+static void Reset() {
+	got.calls = got.events = got.notes = got.controllers = 0;
+}
+
+static intptr_t VSTCALLBACK Host(Vst::AEffect *effect,
+								 Vst::VstOpcodeToHost opcode, int32_t index,
+								 intptr_t value, void *ptr, float opt) {
+	if (opcode != Vst::audioMasterProcessEvents) return 0;
+	Vst::VstEvents *events = (Vst::VstEvents *)ptr;
+	got.calls++;
+	for (int32_t i = 0; i < events->numEvents; i++) {
+		Vst::VstMidiEvent *ev = (Vst::VstMidiEvent *)events->events[i];
+		if (i && ev->deltaFrames < events->events[i - 1]->deltaFrames)
+			got.ordered = false;
+		if (ev->deltaFrames < 0 || ev->deltaFrames >= BLOCK)
+			got.ordered = false;
+
+		int32_t status = ev->midiData & 0xf0;
+		int32_t d1 = (ev->midiData >> 8) & 0x7f;
+		if (status == MIDI_NOTE_ON || status == MIDI_NOTE_OFF) got.notes++;
+		if (status == MIDI_CC && d1 == CUTOFF_CC) got.controllers++;
+		got.events++;
+	}
+	return 1;
+}
+
+static float left[BLOCK], right[BLOCK];
+static float *outputs[2] = {left, right};
+
+static void Render(Vst::AEffect *effect) {
+	effect->processReplacing(effect, NULL, outputs, BLOCK);
+}
+
+// -------- Cases --------
+
+// an arpeggio a few blocks ahead, queued out of order, comes out once
+// per block in frame order
+static bool Arpeggio(Vst::AEffect *effect, int32_t blocks) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	const int32_t step = BLOCK / 8;
+	int32_t notes = 0, calls = 0, max_calls = 0;
+	bool ordered = true;
+
+	Reset();
+	for (int32_t b = 0; b < blocks; b++) {
+		// each block queues the next block but one, last step first
+		int64_t start = plugin->getSampleTime() + 2 * BLOCK;
+		for (int32_t s = 7; s >= 0; s--) {
+			uint8_t key = (uint8_t)(60 + 4 * (s % 3));
+			VSTFX_PendingEvent on = {MIDI_NOTE_ON, key, 100, 1, 0};
+			VSTFX_PendingEvent off = {MIDI_NOTE_OFF, key, 0, 1, 0};
+			plugin->schedule(start + s * step, on);
+			plugin->schedule(start + s * step + step / 2, off);
+		}
+
+		got.calls = 0;
+		got.ordered = true;
+		Render(effect);
+		max_calls = std::max(max_calls, got.calls);
+		calls += got.calls;
+		ordered &= got.ordered;
+	}
+	notes = got.notes;
+
+	// the last two blocks' worth is still queued
+	int32_t expected = 16 * (blocks - 2);
+	bool ok = ordered && max_calls <= 1 && notes == expected;
+	printf("arpeggio     %6d notes in %6d calls, at most %d per block%s\n",
+		   notes, calls, max_calls, ok ? "" : "  (FAIL)");
+	return ok;
+}
+
+// host automation goes back to the controller, the controller's own
+// moves do not
+static bool Feedback(Vst::AEffect *effect, int32_t blocks) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	plugin->getMidiMap()->mapCC(0, CUTOFF_CC, kCutoff);
+
+	// automation, a new 7-bit value every block
+	Reset();
+	for (int32_t b = 0; b < blocks; b++) {
+		effect->setParameter(effect, kCutoff, (b % 128) / 127.0f);
+		Render(effect);
+	}
+	int32_t sent = got.controllers;
+	bool ok = sent >= blocks - 1;
+
+	// the controller moving the same parameter
+	Reset();
+	for (int32_t b = 0; b < blocks; b++) {
+		BenchSendMidi(effect, MIDI_CC, CUTOFF_CC, (uint8_t)(127 - b % 128));
+		Render(effect);
+	}
+	int32_t echoed = got.controllers;
+	ok &= echoed == 0;
+
+	printf("feedback     %6d CCs for %d automated blocks, %d echoed%s\n",
+		   sent, blocks, echoed, ok ? "" : "  (FAIL)");
+	plugin->getMidiMap()->unmap(kCutoff);
+	return ok;
+}
+
+// a block sending more than fits keeps the first ones
+static bool Overflow(Vst::AEffect *effect, int32_t blocks) {
+	VSTFX *plugin = (VSTFX *)effect->object;
+	const int32_t per_block = Vst::VstEvents::MAX_EVENTS;
+	BenchTimer timer;
+	std::vector<double> us;
+	us.reserve(blocks);
+
+	Reset();
+	uint32_t dropped_before = plugin->getDroppedMidi();
+	int32_t refused = 0;
+	for (int32_t b = 0; b < blocks; b++) {
+		timer.start();
+		// two senders, each in frame order, interleaved
+		for (int32_t i = 0; i < per_block + 16; i++) {
+			int32_t delta = (i % 2 ? BLOCK / 2 : 0) + (i / 2) % (BLOCK / 2);
+			refused += !plugin->sendMidi(delta, MIDI_CC, (uint8_t)(i & 0x3f),
+										 (uint8_t)(b & 0x7f));
+		}
+		Render(effect);
+		us.push_back(timer.elapsedUs());
+	}
+
+	uint32_t dropped = plugin->getDroppedMidi() - dropped_before;
+	bool ok = got.events == blocks * per_block && refused == blocks * 16 &&
+			  (int32_t)dropped == refused && got.calls == blocks;
+	printf("full blocks  %6d events, %d refused, %u counted dropped%s\n",
+		   got.events, refused, dropped, ok ? "" : "  (FAIL)");
+	BenchPrintStats("block, 256 sent", "us", BenchSummarize(us));
+	return ok;
+}
+
+int main(int argc, char **argv) {
+	int32_t blocks = (argc > 1) ? atoi(argv[1]) : 2000;
+	if (blocks < 3) blocks = 3;
+
+	Vst::AEffect *effect = VSTPluginMain(Host);
+	effect->dispatcher(effect, Vst::effOpen, 0, 0, NULL, 0.0f);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, RATE);
+	effect->dispatcher(effect, Vst::effMainsChanged, 0, 1, NULL, 0.0f);
+
+	char cap[] = "sendVstMidiEvent";
+	bool ok = effect->dispatcher(effect, Vst::effCanDo, 0, 0, cap, 0.0f) > 0;
+	if (!ok) printf("sendVstMidiEvent not advertised (FAIL)\n");
+
+	long before = BenchAllocations();
+	ok &= Arpeggio(effect, blocks);
+	ok &= Feedback(effect, blocks);
+	long allocated = BenchAllocations() - before;
+	ok &= Overflow(effect, blocks);
+
+	if (allocated) printf("%ld allocations (FAIL)\n", allocated);
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return ok && !allocated ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "bench_common.hpp"
+#include "dsp/voice.hpp"
+#include <cstdlib>
+
+// Renders held voices with a growing number of active routings, per tier,
+// and with a matrix whose slots are all filled but inactive. The cost
+// should follow the active routings; inactive slots should be free.
+//
+// usage: mod_matrix_bench [blocks] [voices]
+
+#define FRAMES 256
+
+static const int32_t dests[] = {VSTFX_MOD_DST_GAIN, VSTFX_MOD_DST_CUTOFF,
+								VSTFX_MOD_DST_RELEASE};
+
+// `active` routings of one tier, plus `inactive` slots that do nothing
+static void Configure(VSTFX_ModMatrix *matrix, int32_t active,
+					  bool audio_rate, int32_t inactive) {
+	for (int32_t i = 0; i < VSTFX_MOD_SLOTS; i++) {
+		VSTFX_ModSlot slot = {VSTFX_MOD_SRC_NONE, VSTFX_MOD_DST_NONE, 0.0f,
+							  false};
+		if (i < active) {
+			slot.source = 1 + i % (VSTFX_MOD_SRC_COUNT - 1);
+			slot.dest = dests[i % 3];
+			slot.amount = 0.01f;
+			slot.audio_rate = audio_rate;
+		} else if (i < active + inactive) {
+			// routed, but with nothing to say
+			slot.source = VSTFX_MOD_SRC_LFO;
+			slot.dest = VSTFX_MOD_DST_GAIN;
+		}
+		matrix->setSlot(i, slot);
+	}
+	matrix->update();
+}
+
+static double Run(VSTFX_VoiceEngine *engine, int blocks) {
+	static float lfo[FRAMES], left[FRAMES], right[FRAMES];
+	for (int i = 0; i < FRAMES; i++)
+		lfo[i] = (i % 64) / 32.0f - 1.0f;
+	VSTFX_VoiceContext ctx = {lfo, 0.0f, 0.5f, VSTFX_WAVE_SINE,
+							   VSTFX_FILTER_OFF, 10.0f, 0.0f};
+
+	BenchTimer timer;
+	double best = 1e30;
+	for (int trial = 0; trial < 5; trial++) {
+		timer.start();
+		for (int i = 0; i < blocks; i++)
+			engine->render(left, right, FRAMES, ctx);
+		best = std::min(best, timer.elapsedUs());
+	}
+	return best / blocks;
+}
+
+int main(int argc, char **argv) {
+	int blocks = (argc > 1) ? atoi(argv[1]) : 2000;
+	int voices = (argc > 2) ? atoi(argv[2]) : 8;
+
+	static VSTFX_VoiceEngine engine;
+	engine.setSampleRate(48000.0f);
+	for (int i = 0; i < voices; i++)
+		engine.noteOn(48 + i * 3, 100);
+
+	VSTFX_ModMatrix *matrix = engine.getMatrix();
+	printf("%d voices, %d frames per block, %d slots\n", voices, FRAMES,
+		   VSTFX_MOD_SLOTS);
+
+	Configure(matrix, 0, false, 0);
+	Run(&engine, blocks / 10); // warm up
+	double empty = Run(&engine, blocks);
+	printf("%-28s %8.3f us/block\n", "empty matrix", empty);
+
+	Configure(matrix, 0, false, VSTFX_MOD_SLOTS);
+	printf("%-28s %8.3f us/block\n", "all slots inactive",
+		   Run(&engine, blocks));
+
+	const int32_t counts[] = {1, 4, 8, 16};
+	for (int tier = 0; tier < 2; tier++) {
+		for (int32_t n : counts) {
+			Configure(matrix, n, tier == 1, 0);
+			double us = Run(&engine, blocks);
+
+			char name[64];
+			snprintf(name, sizeof(name), "%2d %s routings", (int)n,
+					 tier ? "audio rate" : "block rate");
+			printf("%-28s %8.3f us/block, %+7.3f us per routing\n", name, us,
+				   (us - empty) / n);
+		}
+	}
+
+	// audio rate pitch pays for an exp2 per sample
+	VSTFX_ModSlot pitch = {VSTFX_MOD_SRC_LFO, VSTFX_MOD_DST_PITCH, 0.01f, true};
+	Configure(matrix, 0, false, 0);
+	matrix->setSlot(0, pitch);
+	matrix->update();
+	printf("%-28s %8.3f us/block\n", "audio rate pitch", Run(&engine, blocks));
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include "bench_common.hpp"
+#include "dsp/voice.hpp"
+#include "dsp/voice_alloc.hpp"
+#include "util/bits.hpp"
+#include <cstdlib>
+
+// Note on throughput with the voice pool always full, so every note on is
+// a steal: the allocator alone for each policy at 16 and 32 voices, next
+// to the linear oldest-voice scan it replaced, then the whole voice engine
+// including oscillator setup.
+//
+// usage: note_on_bench [notes]
+
+#define RATE 48000.0f
+
+// the previous allocator: scan for a free voice, else the oldest one
+struct LinearScan {
+	struct Voice {
+		bool active;
+		int32_t note;
+		uint32_t started;
+	} voices[VSTFX_ALLOC_MAX_VOICES];
+	int32_t count;
+	uint32_t counter{0};
+
+	explicit LinearScan(int32_t n) : count(n) {
+		for (Voice &v : voices)
+			v = {false, 0, 0};
+	}
+
+	int32_t allocate(int32_t note) {
+		int32_t index = 0;
+		for (int32_t i = 0; i < count; i++) {
+			if (!voices[i].active) {
+				index = i;
+				break;
+			}
+			if (voices[i].started < voices[index].started) index = i;
+		}
+		voices[index] = {true, note, counter++};
+		return index;
+	}
+
+	void release(int32_t note) {
+		for (int32_t i = 0; i < count; i++) {
+			if (voices[i].active && voices[i].note == note)
+				voices[i].active = false;
+		}
+	}
+};
+
+static uint32_t seed = 1;
+static int32_t RandomNote() {
+	seed = seed * 1664525u + 1013904223u;
+	return 24 + (seed >> 16) % 72;
+}
+
+// ns per note on, with a note off for every other note
+template <typename Alloc> static double Run(Alloc &alloc, int notes) {
+	BenchTimer timer;
+	double best = 1e30;
+	for (int trial = 0; trial < 5; trial++) {
+		timer.start();
+		for (int i = 0; i < notes; i++) {
+			int32_t note = RandomNote();
+			alloc.allocate(note);
+			if (i & 1) alloc.release(RandomNote());
+		}
+		best = std::min(best, timer.elapsedUs());
+	}
+	return 1000.0 * best / notes;
+}
+
+// adapts the allocator to Run(), note offs release every held voice
+struct Allocator {
+	VSTFX_VoiceAllocator alloc;
+	explicit Allocator(int32_t n) : alloc(n) {}
+
+	int32_t allocate(int32_t note) {
+		int32_t v = alloc.allocate(note, 100);
+		alloc.setLevel(v, (seed & 0xff) / 255.0f);
+		return v;
+	}
+	void release(int32_t note) {
+		for (uint32_t held = alloc.getHeld(note); held; held &= held - 1)
+			alloc.release(VSTFX_LowestBit(held));
+	}
+};
+
+struct Engine {
+	VSTFX_VoiceEngine *engine;
+	explicit Engine(VSTFX_VoiceEngine *e) : engine(e) {}
+
+	int32_t allocate(int32_t note) {
+		engine->noteOn(note, 100);
+		return 0;
+	}
+	void release(int32_t note) { engine->noteOff(note); }
+};
+
+int main(int argc, char **argv) {
+	int notes = (argc > 1) ? atoi(argv[1]) : 1000000;
+	const char *names[VSTFX_STEAL_POLICY_COUNT] = {"oldest", "quietest",
+												   "same note", "softest"};
+
+	printf("full pool, ns per note on\n");
+	for (int32_t voices : {16, 32}) {
+		LinearScan scan(voices);
+		Run(scan, voices); // fill the pool
+		printf("%2d voices: linear scan %6.2f", (int)voices,
+			   Run(scan, notes));
+
+		for (int p = 0; p < VSTFX_STEAL_POLICY_COUNT; p++) {
+			Allocator a(voices);
+			a.alloc.setPolicy((VSTFX_StealPolicy)p);
+			Run(a, voices);
+			printf("  %s %6.2f", names[p], Run(a, notes));
+		}
+		printf("\n");
+	}
+
+	VSTFX_VoiceEngine *engine = new VSTFX_VoiceEngine();
+	engine->setSampleRate(RATE);
+	Engine e(engine);
+	for (int32_t unison : {1, 16}) {
+		engine->setUnison(unison, 0.3f, 0.5f);
+		printf("engine, unison %2d:", (int)unison);
+		for (int mode = 0; mode < VSTFX_VOICE_MODE_COUNT; mode++) {
+			const char *mode_names[] = {"poly", "mono", "legato"};
+			engine->setMode((VSTFX_VoiceMode)mode, VSTFX_STEAL_OLDEST);
+			Run(e, VSTFX_MAX_VOICES);
+			double ns = Run(e, notes / 10);
+			printf("  %s %7.2f ns (%.1f M notes/s)", mode_names[mode], ns,
+				   1000.0 / ns);
+		}
+		printf("\n");
+	}
+	delete engine;
+	return 0;
+}
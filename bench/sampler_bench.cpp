@@ -0,0 +1,187 @@
+#include "bench_common.hpp"
+#include "dsp/sampler.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+// Load time and RAM of a multisampled library with streaming, against
+// reading every sample into memory, then real time playback of 16 voices
+// retriggered every 250 ms, which has to get through without underruns.
+// Once the voices are done, the disk thread has to stay asleep. The
+// library is written to the current directory and removed afterwards.
+//
+// usage: sampler_bench [files] [seconds per file]
+
+#define FRAMES 64
+#define RATE 48000.0f
+#define RETRIGGER_MS 250
+
+// wakeups allowed while nothing plays, a parked disk thread has none
+#define IDLE_WAKEUPS 20
+
+// voluntary context switches of the process, -1 where they cannot be read
+static long ContextSwitches() {
+#ifdef __linux__
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_nvcsw;
+#endif
+	return -1;
+}
+
+static std::string SamplePath(int i) {
+	char name[64];
+	snprintf(name, sizeof(name), "sampler_bench_%03d.wav", i);
+	return name;
+}
+
+static void Put32(FILE *f, uint32_t v) { fwrite(&v, 4, 1, f); }
+static void Put16(FILE *f, uint16_t v) { fwrite(&v, 2, 1, f); }
+
+// 16 bit stereo sine, a different pitch per file
+static void WriteWav(const std::string &path, int32_t frames, float hz) {
+	FILE *f = fopen(path.c_str(), "wb");
+	uint32_t bytes = (uint32_t)frames * 4;
+
+	fwrite("RIFF", 1, 4, f);
+	Put32(f, 36 + bytes);
+	fwrite("WAVEfmt ", 1, 8, f);
+	Put32(f, 16);
+	Put16(f, 1); // PCM
+	Put16(f, 2);
+	Put32(f, (uint32_t)RATE);
+	Put32(f, (uint32_t)RATE * 4);
+	Put16(f, 4);
+	Put16(f, 16);
+	fwrite("data", 1, 4, f);
+	Put32(f, bytes);
+
+	std::vector<int16_t> pcm(frames * 2);
+	for (int32_t i = 0; i < frames; i++) {
+		int16_t s = (int16_t)(16000.0 * sin(6.283185307 * hz * i / RATE));
+		pcm[2 * i] = pcm[2 * i + 1] = s;
+	}
+	fwrite(pcm.data(), 2, pcm.size(), f);
+	fclose(f);
+}
+
+// what loading without streaming costs: every byte of every file
+static double ReadAll(int files, size_t *bytes) {
+	BenchTimer timer;
+	timer.start();
+	std::vector<std::vector<char>> data(files);
+	*bytes = 0;
+	for (int i = 0; i < files; i++) {
+		FILE *f = fopen(SamplePath(i).c_str(), "rb");
+		fseek(f, 0, SEEK_END);
+		data[i].resize(ftell(f));
+		fseek(f, 0, SEEK_SET);
+		*bytes += fread(data[i].data(), 1, data[i].size(), f);
+		fclose(f);
+	}
+	return timer.elapsedUs() / 1000.0;
+}
+
+int main(int argc, char **argv) {
+	int files = (argc > 1) ? atoi(argv[1]) : 128;
+	float seconds = (argc > 2) ? (float)atof(argv[2]) : 4.0f;
+	if (files > 128) files = 128; // one key each
+
+	int32_t frames = (int32_t)(seconds * RATE);
+	FILE *map = fopen("sampler_bench.sfz", "w");
+	for (int i = 0; i < files; i++) {
+		WriteWav(SamplePath(i), frames, 110.0f + i);
+		fprintf(map, "<region> sample=%s key=%d\n", SamplePath(i).c_str(), i);
+	}
+	fclose(map);
+	printf("%d files of %.1f s, 16 bit stereo\n", files, seconds);
+
+	// -------- Load --------
+
+	size_t read_bytes;
+	double read_ms = 1e30, load_ms = 1e30;
+	for (int trial = 0; trial < 5; trial++)
+		read_ms = std::min(read_ms, ReadAll(files, &read_bytes));
+
+	for (int trial = 0; trial < 5; trial++) {
+		VSTFX_Sampler sampler;
+		if (!sampler.load("sampler_bench.sfz")) {
+			printf("load failed: %s\n", sampler.getError());
+			return 1;
+		}
+		load_ms = std::min(load_ms, sampler.getLoadMs());
+	}
+
+	VSTFX_Sampler *sampler = new VSTFX_Sampler();
+	sampler->setSampleRate(RATE);
+	sampler->load("sampler_bench.sfz");
+
+	printf("read into memory:  %8.2f ms  %8.2f MB resident\n", read_ms,
+		   read_bytes / 1048576.0);
+	printf("mapped, streamed:  %8.2f ms  %8.2f MB resident, %.2f MB mapped\n",
+		   load_ms, sampler->getResidentBytes() / 1048576.0,
+		   sampler->getMappedBytes() / 1048576.0);
+
+	// -------- Real time playback --------
+
+	sampler->update();
+	std::vector<double> render_us;
+	static float left[FRAMES], right[FRAMES];
+
+	int32_t blocks = (int32_t)(seconds * RATE / FRAMES);
+	int32_t retrigger = (int32_t)(RETRIGGER_MS * RATE / 1000.0f / FRAMES);
+	auto period = std::chrono::duration<double>(FRAMES / RATE);
+	auto deadline = std::chrono::steady_clock::now();
+	uint32_t seed = 1;
+
+	BenchTimer timer;
+	for (int32_t b = 0; b < blocks; b++) {
+		timer.start();
+		if (b % retrigger == 0) {
+			for (int v = 0; v < VSTFX_SAMPLER_VOICES; v++) {
+				seed = seed * 1664525u + 1013904223u;
+				sampler->noteOn((seed >> 16) % files, 100);
+			}
+		}
+		sampler->render(left, right, FRAMES);
+		render_us.push_back(timer.elapsedUs());
+
+		deadline += std::chrono::duration_cast<
+			std::chrono::steady_clock::duration>(period);
+		std::this_thread::sleep_until(deadline);
+	}
+
+	BenchPrintStats("render 16 voices", "us", BenchSummarize(render_us));
+	uint32_t underruns = sampler->getUnderruns();
+	printf("underruns: %u over %d blocks %s\n", underruns, (int)blocks,
+		   underruns ? "FAIL" : "ok");
+
+	// -------- Idle --------
+
+	for (int i = 0; i < files; i++)
+		sampler->noteOff(i);
+	while (sampler->getActiveVoices())
+		sampler->render(left, right, FRAMES);
+
+	// the main thread's sleep is one switch, the rest are the disk thread
+	long before = ContextSwitches();
+	std::this_thread::sleep_for(std::chrono::seconds(1));
+	long wakeups = ContextSwitches() - before - 1;
+	bool idle = before < 0 || wakeups <= IDLE_WAKEUPS;
+	if (before < 0) {
+		printf("idle wakeups: not measured here\n");
+	} else {
+		printf("idle wakeups: %ld in 1 s %s\n", wakeups,
+			   idle ? "ok" : "FAIL");
+	}
+
+	delete sampler;
+	for (int i = 0; i < files; i++)
+		remove(SamplePath(i).c_str());
+	remove("sampler_bench.sfz");
+	return underruns || !idle ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+#include "bench_common.hpp"
+#include <cstdlib>
+
+// What a host pays for this plugin on launch: creating and closing an
+// instance, and the whole plugin scan, metadata, parameter names, output
+// pins and editor size included. Neither opens the editor, so neither
+// should create it.
+//
+// usage: startup_bench [instances]
+
+// the questions a scanning host asks between effOpen and effClose
+static bool Scan(Vst::AEffect *effect) {
+	char text[256];
+	effect->dispatcher(effect, Vst::effGetEffectName, 0, 0, text, 0.0f);
+	effect->dispatcher(effect, Vst::effGetVendorString, 0, 0, text, 0.0f);
+	effect->dispatcher(effect, Vst::effGetProductString, 0, 0, text, 0.0f);
+	effect->dispatcher(effect, Vst::effGetVendorVersion, 0, 0, NULL, 0.0f);
+	effect->dispatcher(effect, Vst::effGetVstVersion, 0, 0, NULL, 0.0f);
+	effect->dispatcher(effect, Vst::effGetPlugCategory, 0, 0, NULL, 0.0f);
+
+	const char *caps[] = {"receiveVstEvents", "receiveVstMidiEvent",
+						  "sendVstEvents", "sendVstMidiEvent"};
+	for (const char *cap : caps) {
+		strcpy(text, cap);
+		effect->dispatcher(effect, Vst::effCanDo, 0, 0, text, 0.0f);
+	}
+	effect->dispatcher(effect, Vst::effGetNumMidiInputChannels, 0, 0, NULL,
+					   0.0f);
+	effect->dispatcher(effect, Vst::effGetNumMidiOutputChannels, 0, 0, NULL,
+					   0.0f);
+
+	for (uint32_t i = 0; i < effect->numParams; i++) {
+		Vst::VstParameterProperties props;
+		effect->dispatcher(effect, Vst::effGetParamName, i, 0, text, 0.0f);
+		effect->dispatcher(effect, Vst::effGetParamLabel, i, 0, text, 0.0f);
+		effect->dispatcher(effect, Vst::effGetParamDisplay, i, 0, text, 0.0f);
+		effect->dispatcher(effect, Vst::effGetParameterProperties, i, 0,
+						   &props, 0.0f);
+	}
+	for (int32_t i = 0; i < effect->numOutputs; i++) {
+		Vst::VstPinProperties pin;
+		effect->dispatcher(effect, Vst::effGetOutputProperties, i, 0, &pin,
+						   0.0f);
+	}
+
+	// answered without an editor in builds that have one
+	Vst::ERect *rect = NULL;
+	effect->dispatcher(effect, Vst::effEditGetRect, 0, 0, &rect, 0.0f);
+	bool has_editor = effect->flags & Vst::effFlagsHasEditor;
+	return !has_editor || (rect && rect->Width() > 0 && rect->Height() > 0);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	std::vector<double> create, scan;
+	bool rect_ok = true;
+
+	for (int i = 0; i < count; i++) {
+		BenchTimer timer;
+		timer.start();
+		Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+		effect->dispatcher(effect, Vst::effOpen, 0, 0, NULL, 0.0f);
+		effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+		create.push_back(timer.elapsedUs());
+
+		timer.start();
+		effect = VSTPluginMain(BenchHostCallback);
+		effect->dispatcher(effect, Vst::effOpen, 0, 0, NULL, 0.0f);
+		rect_ok &= Scan(effect);
+		effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+		scan.push_back(timer.elapsedUs());
+	}
+
+	printf("%d instances\n", count);
+	BenchPrintStats("create + close", "us", BenchSummarize(create));
+	BenchPrintStats("plugin scan", "us", BenchSummarize(scan));
+
+	if (!rect_ok) printf("effEditGetRect unanswered before open (FAIL)\n");
+	return rect_ok ? 0 : 1;
+}
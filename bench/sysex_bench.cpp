@@ -0,0 +1,118 @@
+#include "bench_common.hpp"
+#include "core.hpp"
+#include "midi.hpp"
+#include "sysex.hpp"
+#include <cmath>
+#include <cstdlib>
+
+// Sends 128-program bank dumps through effProcessEvents between rendered
+// blocks, like a hardware editor would during playback, and parses them
+// in effIdle. Heap allocations inside effProcessEvents and
+// processReplacing are counted and make the benchmark fail, as does a
+// program change that does not pick up the dumped values.
+//
+// usage: sysex_bench [dumps]
+
+#define FRAMES 64
+
+// -------- Dumps --------
+
+// every program sets every parameter, program n to a value derived from n
+static std::vector<uint8_t> BankDump(int32_t seed) {
+	std::vector<uint8_t> m = {MIDI_SYSEX, VSTFX_SYSEX_ID, VSTFX_SYSEX_BANK, 0,
+							  VSTFX_PROGRAMS - 1};
+	for (int32_t prog = 0; prog < VSTFX_PROGRAMS; prog++) {
+		char name[VSTFX_PATCH_NAME + 1];
+		snprintf(name, sizeof(name), "Program %-8d", (int)prog);
+		m.insert(m.end(), name, name + VSTFX_PATCH_NAME);
+
+		m.push_back(PARAMETER_COUNT);
+		for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+			int32_t v = (prog * 97 + i * 31 + seed) % 16384;
+			m.push_back((uint8_t)i);
+			m.push_back((uint8_t)(v >> 7));
+			m.push_back((uint8_t)(v & 0x7f));
+		}
+	}
+
+	uint32_t sum = 0;
+	for (size_t i = 4; i < m.size(); i++)
+		sum += m[i];
+	m.push_back((uint8_t)((128 - (sum & 0x7f)) & 0x7f));
+	m.push_back(0xf7);
+	return m;
+}
+
+int main(int argc, char **argv) {
+	int dumps = (argc > 1) ? atoi(argv[1]) : 2000;
+
+	Vst::AEffect *effect = VSTPluginMain(BenchHostCallback);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, 48000.0f);
+	VSTFX *plugin = (VSTFX *)effect->object;
+
+	std::vector<uint8_t> dump = BankDump(0);
+	Vst::VstMidiSysexEvent ev{};
+	ev.type = Vst::kVstSysExType;
+	ev.byteSize = sizeof(ev);
+	ev.dumpBytes = (int32_t)dump.size();
+	ev.sysexDump = dump.data();
+
+	Vst::VstEvents events;
+	events.numEvents = 1;
+	events.reserved = 0;
+	events.events[0] = (Vst::VstEvent *)&ev;
+
+	static float left[FRAMES], right[FRAMES];
+	float *outputs[2] = {left, right};
+	BenchSendMidi(effect, MIDI_NOTE_ON, 60, 100);
+
+	// -------- Receive during playback --------
+
+	std::vector<double> receive_us, idle_us;
+	receive_us.reserve(dumps);
+	idle_us.reserve(dumps);
+	BenchTimer timer;
+	long allocated = 0;
+
+	for (int d = 0; d < dumps; d++) {
+		long before = BenchAllocations();
+		timer.start();
+		effect->dispatcher(effect, Vst::effProcessEvents, 0, 0, &events,
+						   0.0f);
+		receive_us.push_back(timer.elapsedUs());
+		effect->processReplacing(effect, NULL, outputs, FRAMES);
+		allocated += BenchAllocations() - before;
+
+		// the host idles far less often than it processes
+		if (d % 4 == 3) {
+			timer.start();
+			effect->dispatcher(effect, Vst::effIdle, 0, 0, NULL, 0.0f);
+			idle_us.push_back(timer.elapsedUs());
+		}
+	}
+	effect->dispatcher(effect, Vst::effIdle, 0, 0, NULL, 0.0f);
+	effect->processReplacing(effect, NULL, outputs, FRAMES);
+
+	printf("%zu byte bank dump, %d dumps\n", dump.size(), dumps);
+	BenchPrintStats("effProcessEvents", "us", BenchSummarize(receive_us));
+	BenchPrintStats("effIdle parse", "us", BenchSummarize(idle_us));
+
+	// -------- Program change --------
+
+	BenchSendMidi(effect, MIDI_PC, 5, 0);
+	float expected = ((5 * 97 + kCutoff * 31) % 16384) / 16383.0f;
+	float cutoff = plugin->getParameter(kCutoff);
+	bool picked = fabsf(cutoff - expected) < 1e-6f;
+
+	VSTFX_SysEx *sysex = plugin->getSysEx();
+	printf("allocations on the audio thread: %ld%s\n", allocated,
+		   allocated ? "  (FAIL)" : "");
+	printf("dropped %u, rejected %u, program 5 cutoff %.4f (expected "
+		   "%.4f)%s\n",
+		   sysex->getDropped(), sysex->getRejected(), cutoff, expected,
+		   picked ? "" : "  (FAIL)");
+
+	bool failed = allocated || !picked || sysex->getRejected();
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return failed ? 1 : 0;
+}
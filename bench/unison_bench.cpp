@@ -0,0 +1,66 @@
+#include "bench_common.hpp"
+#include "dsp/voice.hpp"
+#include <cstdlib>
+
+// Cost per unison voice for both waveforms, and the budget check: an
+// 8-note chord with 16-voice unison rendered in 64-sample blocks at 48 kHz
+// has to take less than the 1333 us those 64 samples last, on one core.
+//
+// usage: unison_bench [blocks]
+
+#define FRAMES 64
+#define RATE 48000.0f
+#define NOTES 8
+
+static double Run(VSTFX_Waveform wave, int32_t unison, int blocks) {
+	VSTFX_VoiceEngine *engine = new VSTFX_VoiceEngine();
+	engine->setSampleRate(RATE);
+	engine->setUnison(unison, 0.4f, 0.8f);
+	for (int i = 0; i < NOTES; i++)
+		engine->noteOn(48 + i * 4, 100);
+
+	static float lfo[FRAMES], left[FRAMES], right[FRAMES];
+	VSTFX_VoiceContext ctx = {lfo, 0.0f, 0.0f, wave,
+							  VSTFX_FILTER_OFF, 10.0f, 0.0f};
+
+	BenchTimer timer;
+	double best = 1e30;
+	for (int trial = 0; trial < 25; trial++) {
+		timer.start();
+		for (int i = 0; i < blocks; i++)
+			engine->render(left, right, FRAMES, ctx);
+		best = std::min(best, timer.elapsedUs());
+	}
+
+	delete engine;
+	return best / blocks;
+}
+
+int main(int argc, char **argv) {
+	int blocks = (argc > 1) ? atoi(argv[1]) : 2000;
+	const int32_t counts[] = {1, 2, 4, 7, 8, 12, 16};
+	const char *names[] = {"sine", "saw"};
+
+	printf("%d notes, %d frames per block, ns per unison voice and sample\n",
+		   NOTES, FRAMES);
+	Run(VSTFX_WAVE_SAW, VSTFX_MAX_UNISON, blocks / 10); // warm up
+
+	for (int32_t unison : counts) {
+		printf("unison %2d:", (int)unison);
+		for (int wave = 0; wave < VSTFX_WAVE_COUNT; wave++) {
+			double us = Run((VSTFX_Waveform)wave, unison, blocks);
+			printf("  %s %6.2f", names[wave],
+				   1000.0 * us / (NOTES * unison * FRAMES));
+		}
+		printf("\n");
+	}
+
+	double budget = 1e6 * FRAMES / RATE;
+	double us = Run(VSTFX_WAVE_SAW, VSTFX_MAX_UNISON, blocks);
+	bool ok = us < budget;
+	printf("%d notes x %d unison saw: %.2f us per %d-sample block, budget "
+		   "%.0f us (%.1f%%) %s\n",
+		   NOTES, VSTFX_MAX_UNISON, us, FRAMES, budget, 100.0 * us / budget,
+		   ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
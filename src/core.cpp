@@ -1,23 +1,42 @@
 #include "core.hpp"
 #include "core_parameters.hpp"
 #include "midi.hpp"
+#include "util/trace.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 
 // adapted from https://mitxela.com/projects/vsti_tutorial
 
-#include <math.h>
-#define PI 3.1415926535897
-#define CLAMP(x, min, max) x < min ? min : (x > max ? max : x)
+// parameter changes glide over this long
+#define SMOOTHING_MS 5.0f
 
-const char* paramNames[PARAMETER_COUNT] = {
-    "Gain",
-    "Release"
-};
+// a normalized parameter value as a 7-bit controller shows it
+static uint8_t ControllerValue(float normalized) {
+	int32_t value = (int32_t)(normalized * 127.0f + 0.5f);
+	return (uint8_t)(value < 0 ? 0 : value > 127 ? 127 : value);
+}
 
-const char *paramLabels[PARAMETER_COUNT] = {"dB", "ms"};
+VSTFX::VSTFX(Vst::AudioMasterCallbackFunc audioMaster)
+	: audioMaster(audioMaster),
+	  arena(VSTFX_Arena::Lines(sizeof(VSTFX_DspState)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_Params)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_Meter)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_Sampler)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_MidiMap)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_SysEx)) +
+			VSTFX_Arena::Lines(sizeof(VSTFX_AudioTap))),
+	  dsp(arena.create<VSTFX_DspState>()),
+	  params(arena.create<VSTFX_Params>()),
+	  meter(arena.create<VSTFX_Meter>()),
+	  sampler(arena.create<VSTFX_Sampler>()),
+	  midi_map(arena.create<VSTFX_MidiMap>()),
+	  sysex(arena.create<VSTFX_SysEx>()),
+	  tap(arena.create<VSTFX_AudioTap>()) {
+	// VSTPluginMain tells the host
+	if (!isValid()) return;
 
-VSTFX::VSTFX(Vst::AudioMasterCallbackFunc audioMaster) {
 	effect.magic = Vst::kEffectMagic;
 	effect.dispatcher = callDispatcher;
 	// effect.process
@@ -26,9 +45,10 @@ VSTFX::VSTFX(Vst::AudioMasterCallbackFunc audioMaster) {
 	effect.numPrograms = 0;
 	effect.numParams = PARAMETER_COUNT;
 	effect.numInputs = 0;
-	effect.numOutputs = 2;
-	effect.flags = Vst::effFlagsIsSynth |     // "trust me, I'm a VSTi"
-				   Vst::effFlagsCanReplacing; // able to output audio
+	effect.numOutputs = VSTFX_OutputChannels(layout);
+	effect.flags = Vst::effFlagsIsSynth |      // "trust me, I'm a VSTi"
+				   Vst::effFlagsCanReplacing | // able to output audio
+				   Vst::effFlagsHasVu;         // answers effGetVu
 	//
 	//
 	// effect.initialDelay
@@ -42,10 +62,17 @@ VSTFX::VSTFX(Vst::AudioMasterCallbackFunc audioMaster) {
 	effect.processReplacing = callProcessReplacing;
 	// effect.processDoubleReplacing
 
-	// instantiate GUI
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		dsp->smooth[i].reset(params->plain(i));
+		dsp->cc_sent[i] = ControllerValue(params->get(i));
+	}
+	setSampleRate(sample_rate);
+
+	VSTFX_Trace::Acquire();
+
+	// the editor itself waits for effEditOpen, scans never pay for it
 #ifdef WITH_GUI
-	editor = new VSTFX_GUI(this);
-	if (editor) effect.flags |= Vst::effFlagsHasEditor;
+	effect.flags |= Vst::effFlagsHasEditor;
 #endif
 }
 
@@ -53,6 +80,7 @@ VSTFX::~VSTFX() {
 #ifdef WITH_GUI
 	if (editor) delete editor;
 #endif
+	if (isValid()) VSTFX_Trace::Release();
 }
 
 // -------- Set up basic VST info --------
@@ -61,6 +89,9 @@ VSTFX::~VSTFX() {
 int32_t VSTFX::canDo(char *capability) {
 	CAN_I_DO("receiveVstEvents", YES_I_CAN);
 	CAN_I_DO("receiveVstMidiEvent", YES_I_CAN);
+	CAN_I_DO("receiveVstTimeInfo", YES_I_CAN);
+	CAN_I_DO("sendVstEvents", YES_I_CAN);
+	CAN_I_DO("sendVstMidiEvent", YES_I_CAN);
 	return NO_I_CANT;
 }
 
@@ -69,122 +100,429 @@ int32_t VSTFX::getNumMidiInputChannels() {
 }
 
 int32_t VSTFX::getNumMidiOutputChannels() {
-	return 0; // 0 for no midi output
+	return 16; // controller feedback goes out on the mapped channel
+}
+
+void VSTFX::setSampleRate(float sr) {
+	sample_rate = sr;
+	dsp->voices.setSampleRate(sr);
+	sampler->setSampleRate(sr);
+	dsp->delay[0].setSampleRate(sr);
+	dsp->delay[1].setSampleRate(sr);
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		dsp->smooth[i].setRampLength(
+			(int32_t)(sr * SMOOTHING_MS / 1000.0f));
+	}
+}
+
+void VSTFX::resume() {
+	dsp->delay[0].clear();
+	dsp->delay[1].clear();
+
+	// effIdle parses SysEx while the editor is shut
+	hostCallback(Vst::audioMasterNeedIdle);
+}
+
+void VSTFX::idle() { sysex->idle(); }
+
+bool VSTFX::setSpeakerArrangement(Vst::VstSpeakerArrangement *outputs) {
+	VSTFX_OutputLayout next;
+	if (!outputs || !VSTFX_OutputLayoutFor(outputs->numChannels, &next))
+		return false;
+
+	// hosts only ask while suspended, so the audio thread is not running
+	int32_t channels = VSTFX_OutputChannels(next);
+	bool changed = channels != effect.numOutputs;
+	layout = next;
+	effect.numOutputs = channels;
+
+	// the host rereads the pins only when told they changed
+	if (changed) hostCallback(Vst::audioMasterIOChanged);
+	return true;
 }
 
-void VSTFX::setSampleRate(float sr) { sample_rate = sr; }
+void VSTFX::setQuality(VSTFX_Quality q) {
+	if (q == dsp->quality) return;
+	VSTFX_TraceSpan span("audio", "setQuality", "offline",
+						 q == VSTFX_QUALITY_OFFLINE);
+	dsp->quality = q;
+	dsp->voices.setQuality(q);
+}
+
+bool VSTFX::setProcessPrecision(Vst::VstProcessPrecision precision) {
+	precision64 = precision == Vst::kVstProcessPrecision64;
+	// only processReplacing exists
+	return precision == Vst::kVstProcessPrecision32;
+}
 
 // -------- Output samples --------
 
 void VSTFX::processReplacing(float **inputs, float **outputs,
 							 int32_t sampleFrames) {
-	float *out1 = outputs[0]; // usually the left channel
-	float *out2 = outputs[1]; // usually the right channel
+	// offline renders get the expensive kernels, starting with this block
+	intptr_t level = hostCallback(Vst::audioMasterGetCurrentProcessLevel);
+	bool offline = level == Vst::kVstProcessLevelOffline || precision64;
+	setQuality(offline ? VSTFX_QUALITY_OFFLINE : VSTFX_QUALITY_REALTIME);
+
+	VSTFX_TraceSpan span("audio",
+						 dsp->quality == VSTFX_QUALITY_OFFLINE
+							 ? "processReplacing.offline"
+							 : "processReplacing",
+						 "frames", sampleFrames);
+	int32_t frames = sampleFrames;
+
+	// the only host time query, everything below reads the transport
+	dsp->transport.update((Vst::VstTimeInfo *)hostCallback(
+							  Vst::audioMasterGetTime, 0,
+							  VSTFX_Transport::kQueryFlags),
+						  sample_rate, frames);
+	dsp->lfo.begin(dsp->transport, (int32_t)params->plain(kLfoRate));
+	dsp->delay[0].begin(dsp->transport, (int32_t)params->plain(kDelayTime));
+	dsp->delay[1].begin(dsp->transport, (int32_t)params->plain(kDelayTime));
+
+	sampler->update();
+	sysex->apply(params);
+
+	// host automation, MIDI controllers and patches all end up here
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		dsp->smooth[i].setTarget(params->plain(i));
+	}
+	sendFeedback();
 
-	while (--sampleFrames >= 0) {
-		// dump samples here...
-		float sample_out = (((vol - timer) < 0.0) ? 0.0 : (vol - timer)) *
-						   sin(phase += freq) * fGain;
+	// one branch per block, each layout and quality has a loop of its own
+	if (dsp->quality == VSTFX_QUALITY_OFFLINE) {
+		renderLayout<VSTFX_QUALITY_OFFLINE>(outputs, frames);
+	} else {
+		renderLayout<VSTFX_QUALITY_REALTIME>(outputs, frames);
+	}
 
-		// clamp output
-		(*out1++) = (*out2++) = sample_out;
+	dsp->clock += frames;
 
-		timer += fRelease / sample_rate; // fade out
+	// everything the block sent, in one call
+	if (Vst::VstEvents *out = dsp->midi_out.finish()) {
+		hostCallback(Vst::audioMasterProcessEvents, 0, 0, out);
+		dsp->midi_out.clear();
 	}
 
-	while (phase > PI)
-		phase -= 2 * PI;
+	// publish output levels, of the mix
+	meter->process(outputs, layout == VSTFX_OUTPUT_MONO ? 1 : 2, frames);
+
+	// feed the editor's scope, a no-op while the editor is closed
+	tap->push(outputs[0], frames);
+}
+
+template <VSTFX_Quality Q>
+void VSTFX::renderLayout(float **outputs, int32_t frames) {
+	switch (layout) {
+		case VSTFX_OUTPUT_MONO:
+			render<VSTFX_OUTPUT_MONO, Q>(outputs, frames);
+			break;
+		case VSTFX_OUTPUT_MULTI:
+			render<VSTFX_OUTPUT_MULTI, Q>(outputs, frames);
+			break;
+		default:
+			render<VSTFX_OUTPUT_STEREO, Q>(outputs, frames);
+			break;
+	}
+}
+
+template <VSTFX_OutputLayout L, VSTFX_Quality Q>
+void VSTFX::render(float **outputs, int32_t frames) {
+	typedef VSTFX_OutputTraits<L> Out;
+
+	// scratch sits in the arena, on lines the audio thread already owns
+	VSTFX_DspState &d = *dsp;
+	float *lfo_out = d.lfo_out;
+	float *voice_l = d.voice_l, *voice_r = d.voice_r;
+	float *sampler_l = d.sampler_l, *sampler_r = d.sampler_r;
+
+	for (int32_t offset = 0, n; offset < frames; offset += n) {
+		n = frames - offset;
+		if (n > VSTFX_RENDER_CHUNK) n = VSTFX_RENDER_CHUNK;
+
+		// queued events start a chunk of their own, to the frame
+		int64_t now = d.clock + offset;
+		if (d.pending.next() <= now) dispatchPending(now);
+		if (d.pending.next() - now < n) n = (int32_t)(d.pending.next() - now);
+
+		for (int32_t i = 0; i < n; i++)
+			lfo_out[i] = d.lfo.next();
+
+		// voices read these once per chunk
+		VSTFX_VoiceContext ctx;
+		ctx.lfo = lfo_out;
+		ctx.release = d.smooth[kRelease].advance(n);
+		ctx.modwheel = d.modwheel;
+		ctx.wave = (VSTFX_Waveform)(int32_t)params->plain(kWaveform);
+		ctx.filter = (VSTFX_FilterType)(int32_t)params->plain(kFilterType);
+		ctx.cutoff = log2f(d.smooth[kCutoff].advance(n) / VSTFX_FILTER_MIN_HZ);
+		ctx.resonance = d.smooth[kResonance].advance(n);
+
+		std::fill(voice_l, voice_l + n, 0.0f);
+		std::fill(voice_r, voice_r + n, 0.0f);
+		d.voices.render(voice_l, voice_r, n, ctx);
+
+		if (Out::LAYERS) {
+			// each layer goes out dry on its own pair, then into the mix
+			std::fill(sampler_l, sampler_l + n, 0.0f);
+			std::fill(sampler_r, sampler_r + n, 0.0f);
+			sampler->render(sampler_l, sampler_r, n);
+
+			std::copy(voice_l, voice_l + n, outputs[2] + offset);
+			std::copy(voice_r, voice_r + n, outputs[3] + offset);
+			std::copy(sampler_l, sampler_l + n, outputs[4] + offset);
+			std::copy(sampler_r, sampler_r + n, outputs[5] + offset);
+			for (int32_t i = 0; i < n; i++) {
+				voice_l[i] += sampler_l[i];
+				voice_r[i] += sampler_r[i];
+			}
+		} else {
+			sampler->render(voice_l, voice_r, n);
+		}
+
+		float *out1 = outputs[0] + offset;
+		float *out2 = outputs[Out::MIX - 1] + offset; // out1 in mono
+		for (int32_t i = 0; i < n; i++) {
+			float gain = d.smooth[kVolume].next();
+
+			// tremolo, dips to 1 - depth on the LFO's troughs
+			float depth = d.smooth[kLfoDepth].next();
+			gain *= 1.0f - depth * (0.5f - 0.5f * lfo_out[i]);
+
+			float feedback = d.smooth[kDelayFeedback].next();
+			float mix = d.smooth[kDelayMix].next();
+			float l = d.delay[0].process<Q>(voice_l[i] * gain, feedback, mix);
+			float r = d.delay[1].process<Q>(voice_r[i] * gain, feedback, mix);
+			if (Out::MIX == 1) {
+				out1[i] = 0.5f * (l + r);
+			} else {
+				out1[i] = l;
+				out2[i] = r;
+			}
+		}
+	}
 }
 
 // -------- Process MIDI input --------
 
 int32_t VSTFX::processEvents(Vst::VstEvents *e) {
+	VSTFX_TraceSpan span("audio", "processEvents", "events", e->numEvents);
+	sampler->update();
+	sysex->apply(params);
+
+	// notes starting in this batch take the current voice settings
+	VSTFX_VoiceEngine &voices = dsp->voices;
+	voices.setUnison((int32_t)params->plain(kUnison), params->plain(kDetune),
+					 params->plain(kSpread));
+	VSTFX_StealPolicy steal =
+		(VSTFX_StealPolicy)(int32_t)params->plain(kSteal);
+	voices.setMode((VSTFX_VoiceMode)(int32_t)params->plain(kVoiceMode), steal);
+	sampler->setPolicy(steal);
+
 	for (int32_t i = 0; i < e->numEvents; i++) {
+		// copied for idle() to parse, never parsed here
+		if ((e->events[i])->type == Vst::kVstSysExType) {
+			Vst::VstMidiSysexEvent *sysex_event =
+				(Vst::VstMidiSysexEvent *)e->events[i];
+			sysex->receive(sysex_event->sysexDump, sysex_event->dumpBytes);
+			continue;
+		}
 		if ((e->events[i])->type != Vst::kVstMidiType) continue;
 
 		Vst::VstMidiEvent *event = (Vst::VstMidiEvent *)e->events[i];
 		char *midiData = (char *)&event->midiData;
+		int32_t status = midiData[0] & 0xf0;
+		if (status != MIDI_NOTE_ON && status != MIDI_NOTE_OFF) {
+			handleMidi(midiData);
+			continue;
+		}
 
-		// do something with the midi data...
-		int32_t status = midiData[0] & 0xf0; // ignoring channel
-
-		switch (status) {
-			case MIDI_PITCH_BEND:
-			case MIDI_CC:
-				break;
-			case MIDI_NOTE_ON:
-			case MIDI_NOTE_OFF:
-				int32_t note = midiData[1] & 0x7f;
-				int32_t velocity = midiData[2] & 0x7f;
-
-				if (status == MIDI_NOTE_OFF || velocity == 0) {
-					// Note Off
-					vol = 0;
-				} else {
-					// Note On
-					// Note 69 is A (440Hz). 12 notes per octave.
-					// Multiply by 2pi/fs to get frequency in units of radians
-					// per sample
-					freq = (440 * 2 * PI / sample_rate) *
-						   pow(2.0, (note - 69) / 12.0);
-					vol = .8;
-					timer = 0.0;
-				}
-				break;
+		// notes wait in the queue for their frame, render() starts a
+		// chunk there
+		VSTFX_PendingEvent note;
+		note.status = (uint8_t)midiData[0];
+		note.data1 = (uint8_t)(midiData[1] & 0x7f);
+		note.data2 = (uint8_t)(midiData[2] & 0x7f);
+		note.output = 0;
+		bool on = status == MIDI_NOTE_ON && note.data2;
+		note.serial = on ? newNoteSerial() : 0;
+
+		// with the queue full, late beats never
+		int64_t start = dsp->clock + event->deltaFrames;
+		if (!schedule(start, note)) handleMidi(midiData, note.serial);
+
+		// a note that says how long it lasts gets its note off queued,
+		// however many blocks away that is, counted from its start
+		if (on && event->noteLength > 0) {
+			VSTFX_PendingEvent off;
+			off.status = (uint8_t)(MIDI_NOTE_OFF | (midiData[0] & 0x0f));
+			off.data1 = note.data1;
+			off.data2 = 0;
+			off.output = 0;
+			off.serial = note.serial;
+			schedule(start + event->noteLength - event->noteOffset, off);
 		}
 	}
+
+	// one parameter update per mapped controller, however many messages
+	applyMidiMap();
 	return true;
 }
 
-// -------- Process parameters --------
+void VSTFX::handleMidi(const char *midiData, uint32_t serial) {
+	int32_t status = midiData[0] & 0xf0;
+	int32_t channel = midiData[0] & 0x0f;
 
-void VSTFX::setParameter(int32_t index, float value) {
-	switch (index) {
-		case kVolume:
-			fGain = value;
+	switch (status) {
+		case MIDI_PITCH_BEND:
+			midi_map->pitchBend(channel, midiData[1] & 0x7f,
+							   midiData[2] & 0x7f);
 			break;
-		case kRelease:
-			fRelease = 1.0 - value;
+		case MIDI_PC:
+			sysex->programChange(midiData[1] & 0x7f, params);
+			break;
+		case MIDI_CC:
+			if ((midiData[1] & 0x7f) == MIDI_CC_MODWHEEL) {
+				dsp->modwheel = (midiData[2] & 0x7f) / 127.0f;
+			}
+			midi_map->controlChange(channel, midiData[1] & 0x7f,
+								   midiData[2] & 0x7f);
+			break;
+		case MIDI_NOTE_ON:
+		case MIDI_NOTE_OFF:
+			int32_t note = midiData[1] & 0x7f;
+			int32_t velocity = midiData[2] & 0x7f;
+
+			// notes already sounding still get their note off
+			if (status == MIDI_NOTE_OFF || velocity == 0) {
+				dsp->voices.noteOff(note);
+				sampler->noteOff(note);
+				break;
+			}
+			dsp->note_serial[note] = serial ? serial : newNoteSerial();
+			if (sampler->hasLibrary()) {
+				sampler->noteOn(note, velocity);
+			} else {
+				dsp->voices.noteOn(note, velocity);
+			}
 			break;
 	}
 }
 
-float VSTFX::getParameter(int32_t index) {
-	switch (index) {
-		case kVolume:
-			return fGain;
-		case kRelease:
-			return 1.0 - fRelease;
+// -------- Future events --------
+
+uint32_t VSTFX::newNoteSerial() {
+	// 0 stands for no serial, so it is skipped when the count wraps
+	if (++dsp->last_serial == 0) dsp->last_serial = 1;
+	return dsp->last_serial;
+}
+
+bool VSTFX::schedule(int64_t time, const VSTFX_PendingEvent &event) {
+	return dsp->pending.push(time, event);
+}
+
+void VSTFX::dispatchPending(int64_t now) {
+	VSTFX_PendingEvent e;
+	bool any = false;
+	while (dsp->pending.pop(now, &e)) {
+		if (e.output) {
+			sendMidi((int32_t)(now - dsp->clock), e.status, e.data1, e.data2);
+			continue;
+		}
+
+		// the key was played again, its newer note keeps sounding
+		bool note_off = (e.status & 0xf0) == MIDI_NOTE_OFF;
+		if (note_off && e.serial && e.serial != dsp->note_serial[e.data1])
+			continue;
+
+		char data[3] = {(char)e.status, (char)e.data1, (char)e.data2};
+		handleMidi(data, e.serial);
+		any = true;
 	}
-	return 0.0;
+	if (any) applyMidiMap();
+}
+
+// -------- MIDI output --------
+
+bool VSTFX::sendMidi(int32_t delta, uint8_t status, uint8_t data1,
+					 uint8_t data2) {
+	return dsp->midi_out.send(delta, status, data1, data2);
+}
+
+void VSTFX::applyMidiMap() {
+	VSTFX_ParamMask received = midi_map->apply(params);
+	for (int32_t i = 0; received.any() && i < PARAMETER_COUNT; i++) {
+		if (received.test(i))
+			dsp->cc_sent[i] = ControllerValue(params->get(i));
+	}
+}
+
+void VSTFX::sendFeedback() {
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		uint8_t value = ControllerValue(params->get(i));
+		if (value == dsp->cc_sent[i]) continue;
+		dsp->cc_sent[i] = value;
+
+		// 14-bit pairs get the MSB, which 7-bit controllers also read
+		VSTFX_MidiSource src = midi_map->getSource(i);
+		if (src.type == VSTFX_MIDI_SOURCE_CC) {
+			sendMidi(0, (uint8_t)(MIDI_CC | src.channel),
+					 (uint8_t)src.number, value);
+		}
+	}
+}
+
+// -------- Process parameters --------
+
+void VSTFX::setParameter(int32_t index, float value) {
+	if (!VSTFX_Params::IsValid(index)) return;
+	params->set(index, value);
+}
+
+float VSTFX::getParameter(int32_t index) {
+	if (!VSTFX_Params::IsValid(index)) return 0.0;
+	return params->get(index);
+}
+
+bool VSTFX::canBeAutomated(int32_t index) {
+	if (!VSTFX_Params::IsValid(index)) return false;
+	return paramTable[index].flags & VSTFX_PARAM_AUTOMATABLE;
+}
+
+bool VSTFX::getParameterProperties(int32_t index,
+								   Vst::VstParameterProperties *props) {
+	if (!VSTFX_Params::IsValid(index) || !props) return false;
+	VSTFX_Params::GetProperties(index, props);
+	return true;
+}
+
+bool VSTFX::string2Parameter(int32_t index, char *text) {
+	if (!VSTFX_Params::IsValid(index)) return false;
+	// hosts may pass NULL just to ask whether parsing is supported
+	if (!text) return true;
+
+	float plain;
+	if (!VSTFX_Params::Parse(index, text, &plain)) return false;
+	setParameter(index, VSTFX_Params::ToNormalized(index, plain));
+	return true;
 }
 
 // -------- Process parameter display --------
 
 void VSTFX::getParameterName(int32_t index, char *label) {
-	snprintf(label, Vst::kVstMaxParamStrLen, "%s", paramNames[index]);
+	if (!VSTFX_Params::IsValid(index)) return;
+	snprintf(label, Vst::kVstMaxParamStrLen, "%s", paramTable[index].name);
 }
 
 void VSTFX::getParameterLabel(int32_t index, char *label) {
-	snprintf(label, Vst::kVstMaxParamStrLen, "%s", paramNames[index]);
+	if (!VSTFX_Params::IsValid(index)) return;
+	snprintf(label, Vst::kVstMaxParamStrLen, "%s", paramTable[index].label);
 }
 
 void VSTFX::getParameterDisplay(int32_t index, char *text) {
 	// used as fallback when no GUI is available
-	switch (index) {
-		case kVolume:
-			sprintf(text, "%.1f", fGain);
-			break;
-		case kRelease:
-			if (fRelease == 0.0) {
-				sprintf(text, "inf");
-				break;
-			} else {
-				sprintf(text, "%.1f",
-						CLAMP((1.8 - fRelease) * 1000, 0.0, 10000.0));
-				break;
-			}
-	}
+	if (!VSTFX_Params::IsValid(index)) return;
+	VSTFX_Params::Format(index, params->plain(index), text);
 }
 
 // -------- Metadata --------
@@ -244,6 +582,37 @@ intptr_t VSTFX::dispatch(Vst::VstOpcodeToPlugin opcode, int32_t index,
 		case Vst::effGetParamLabel:
 			getParameterLabel(index, (char *)ptr);
 			break;
+		case Vst::effGetParameterProperties:
+			result = getParameterProperties(
+				index, (Vst::VstParameterProperties *)ptr);
+			break;
+		case Vst::effCanBeAutomated:
+			result = canBeAutomated(index);
+			break;
+		case Vst::effString2Parameter:
+			result = string2Parameter(index, (char *)ptr);
+			break;
+
+		// report output level, 32767 is full scale
+		case Vst::effGetVu: {
+			float vu = meter->getVu();
+			result = (intptr_t)((vu > 1.0f ? 1.0f : vu) * 32767.0f);
+			break;
+		}
+
+		// report and negotiate the output layout
+		case Vst::effGetOutputProperties:
+			result = VSTFX_GetOutputProperties(layout, index,
+											   (Vst::VstPinProperties *)ptr);
+			break;
+		case Vst::effSetSpeakerArrangement:
+			result = setSpeakerArrangement((Vst::VstSpeakerArrangement *)ptr);
+			break;
+
+		// offline renders and 64 bit requests get the expensive kernels
+		case Vst::effSetProcessPrecision:
+			result = setProcessPrecision((Vst::VstProcessPrecision)value);
+			break;
 
 		// report capabilities
 		case Vst::effCanDo:
@@ -259,6 +628,12 @@ intptr_t VSTFX::dispatch(Vst::VstOpcodeToPlugin opcode, int32_t index,
 			break;
 
 		// handle stuff
+		case Vst::effMainsChanged:
+			if (value) resume();
+			break;
+		case Vst::effIdle:
+			idle();
+			break;
 		case Vst::effSetSampleRate:
 			setSampleRate(opt);
 			break;
@@ -269,15 +644,30 @@ intptr_t VSTFX::dispatch(Vst::VstOpcodeToPlugin opcode, int32_t index,
 #ifdef WITH_GUI
 		// handle gui stuff
 		case Vst::effEditOpen:
-			if (editor) editor->open(ptr);
+			if (!editor) editor = new VSTFX_GUI(this);
+			editor->open(ptr);
+			break;
+		case Vst::effEditClose:
+			if (editor) editor->close();
 			break;
 		case Vst::effEditGetRect:
-			if (editor) result = editor->getRect((Vst::ERect **)ptr);
+			// hosts ask for the size before opening the editor
+			if (editor) {
+				result = editor->getRect((Vst::ERect **)ptr);
+			} else {
+				*(Vst::ERect **)ptr = &editor_rect;
+				result = 1;
+			}
 			break;
-		case Vst::effEditIdle:
+#endif
+		case Vst::effEditIdle: {
+			VSTFX_TraceSpan span("editor", "effEditIdle");
+			idle();
+#ifdef WITH_GUI
 			if (editor) editor->idle();
-			break;
 #endif
+			break;
+		}
 
 		default:
 			break;
@@ -323,6 +713,26 @@ float VSTFX::callGetParameter(Vst::AEffect *effect, int32_t index) {
 	return e->getParameter(index);
 }
 
+// -------- Host callback --------
+
+intptr_t VSTFX::hostCallback(Vst::VstOpcodeToHost opcode, int32_t index,
+							 intptr_t value, void *ptr, float opt) {
+	if (!audioMaster) return 0;
+	return audioMaster(&effect, opcode, index, value, ptr, opt);
+}
+
+void VSTFX::beginEdit(int32_t index) {
+	hostCallback(Vst::audioMasterBeginEdit, index);
+}
+
+void VSTFX::automate(int32_t index, float value) {
+	hostCallback(Vst::audioMasterAutomate, index, 0, NULL, value);
+}
+
+void VSTFX::endEdit(int32_t index) {
+	hostCallback(Vst::audioMasterEndEdit, index);
+}
+
 // -------- Entry point --------
 
 Vst::AEffect *VSTFX::getPluginInstance() { return &effect; }
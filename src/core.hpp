@@ -1,7 +1,23 @@
 #ifndef VSTFX_CORE_H
 #define VSTFX_CORE_H
 
+#include "core_parameters.hpp"
+#include "dsp/audio_tap.hpp"
+#include "dsp/meter.hpp"
+#include "dsp/quality.hpp"
+#include "dsp/sampler.hpp"
+#include "dsp/smoother.hpp"
+#include "dsp/synced.hpp"
+#include "dsp/transport.hpp"
+#include "dsp/voice.hpp"
+#include "midi_map.hpp"
+#include "midi_out.hpp"
+#include "output_layout.hpp"
+#include "sysex.hpp"
+#include "util/arena.hpp"
+#include "util/event_heap.hpp"
 #include "vst.h"
+#include <cstring>
 
 #ifdef WITH_GUI
 #include "gui/gui.hpp"
@@ -14,6 +30,60 @@
 #define I_DUNNO 0
 #define NO_I_CANT -1
 
+// voices and the LFO are rendered this many frames at a time
+#define VSTFX_RENDER_CHUNK 64
+
+// MIDI messages that can wait for a later block at once
+#define VSTFX_PENDING_EVENTS 65536
+
+/*!
+ * \brief A channel message waiting for its time. Note ons carry a serial
+ * that the key keeps while the note sounds. Note offs queued for a note
+ * on carry the same serial and are dropped if the key has been played
+ * again since.
+ */
+struct VSTFX_PendingEvent {
+	uint8_t status{0}, data1{0}, data2{0};
+	uint8_t output{0};	// 1 goes to the host instead of the voices
+	uint32_t serial{0}; // 0 applies always
+};
+
+/*!
+ * \brief Everything the audio thread writes while rendering, apart from
+ * the sampler, the MIDI map, the SysEx receiver and the audio tap, which
+ * have arena lines of their own. Inside it, only the editor's side of the
+ * voices' mod matrix is written by another thread, and the matrix pads it
+ * off. The per sample state comes first, the voices, used once per chunk,
+ * last.
+ */
+struct VSTFX_DspState {
+	VSTFX_Smoother smooth[PARAMETER_COUNT];
+	float modwheel{0.0f};
+	VSTFX_Quality quality{VSTFX_QUALITY_REALTIME};
+
+	// tempo sync, the transport is refreshed once per block
+	VSTFX_Transport transport;
+	VSTFX_SyncedLfo lfo;
+	VSTFX_SyncedDelay delay[2];
+
+	// render() scratch, one chunk
+	float lfo_out[VSTFX_RENDER_CHUNK];
+	float voice_l[VSTFX_RENDER_CHUNK], voice_r[VSTFX_RENDER_CHUNK];
+	float sampler_l[VSTFX_RENDER_CHUNK], sampler_r[VSTFX_RENDER_CHUNK];
+
+	VSTFX_VoiceEngine voices;
+
+	// absolute time of the next block's first frame
+	int64_t clock{0};
+	uint32_t note_serial[128]{}; // the sounding note on of each key
+	uint32_t last_serial{0};	 // the serial handed out last, never 0
+	VSTFX_EventHeap<VSTFX_PendingEvent, VSTFX_PENDING_EVENTS> pending;
+
+	// sent to the host once per block
+	VSTFX_MidiOut midi_out;
+	uint8_t cc_sent[PARAMETER_COUNT]; // what controllers last showed
+};
+
 class VSTFX {
 public:
 	VSTFX(Vst::AudioMasterCallbackFunc audioMaster);
@@ -23,12 +93,66 @@ public:
 						  int32_t sampleFrames);
 	int32_t processEvents(Vst::VstEvents *events);
 
+	/*!
+	 * \brief Queues a channel message for absolute sample `time`, counted
+	 * from the first frame the instance rendered. Audio thread only,
+	 * false if the queue is full.
+	 */
+	bool schedule(int64_t time, const VSTFX_PendingEvent &event);
+	int64_t getSampleTime() const { return dsp->clock; }
+
+	/*!
+	 * \brief Sends a channel message to the host, `delta` frames into the
+	 * block being rendered. Audio thread only, false if the block has
+	 * sent all it can.
+	 */
+	bool sendMidi(int32_t delta, uint8_t status, uint8_t data1,
+				  uint8_t data2);
+
+	size_t getPendingEvents() const { return dsp->pending.size(); }
+
+	// messages sendMidi() refused so far, audio thread only
+	uint32_t getDroppedMidi() const { return dsp->midi_out.getDropped(); }
+
 	int32_t canDo(char *text);
 
+	/*!
+	 * \brief Housekeeping off the audio thread, from effIdle and
+	 * effEditIdle: parses received SysEx.
+	 */
+	void idle();
+
 	int32_t getNumMidiInputChannels();
 	int32_t getNumMidiOutputChannels();
 	void setSampleRate(float sr);
 
+	/*!
+	 * \brief effMainsChanged on: clears the delay lines, so their pages
+	 * are faulted in here rather than on the audio thread, and asks for
+	 * effIdle.
+	 */
+	void resume();
+
+	/*!
+	 * \brief Switches to the layout with the host's number of outputs,
+	 * false if there is none.
+	 */
+	bool setSpeakerArrangement(Vst::VstSpeakerArrangement *outputs);
+
+	/*!
+	 * \brief Picks the kernels, from the block about to render on. Called
+	 * at the start of each block with what the host reports, the switch
+	 * shows up in the trace.
+	 */
+	void setQuality(VSTFX_Quality q);
+	VSTFX_Quality getQuality() const { return dsp->quality; }
+
+	/*!
+	 * \brief effSetProcessPrecision. Processing stays 32 bit, a host
+	 * asking for 64 gets the offline kernels instead.
+	 */
+	bool setProcessPrecision(Vst::VstProcessPrecision precision);
+
 	int32_t getVendorVersion();
 	bool getEffectName(char *name);
 	bool getProductString(char *text);
@@ -43,8 +167,39 @@ public:
 	void getParameterLabel(int32_t index, char *label);
 	void getParameterDisplay(int32_t index, char *text);
 
+	bool canBeAutomated(int32_t index);
+	bool getParameterProperties(int32_t index,
+								Vst::VstParameterProperties *props);
+	bool string2Parameter(int32_t index, char *text);
+
 	Vst::AEffect *getPluginInstance();
 
+	// false if the instance could not get its memory
+	bool isValid() const {
+		return dsp && params && meter && sampler && midi_map && sysex && tap;
+	}
+
+	/*!
+	 * \brief Calls back into the host, returns 0 if there is no host.
+	 */
+	intptr_t hostCallback(Vst::VstOpcodeToHost opcode, int32_t index = 0,
+						  intptr_t value = 0, void *ptr = NULL,
+						  float opt = 0.0f);
+
+	// host automation, called from the editor thread
+	void beginEdit(int32_t index);
+	void automate(int32_t index, float value);
+	void endEdit(int32_t index);
+
+	VSTFX_AudioTap *getAudioTap() { return tap; }
+	VSTFX_Meter *getMeter() { return meter; }
+	VSTFX_MidiMap *getMidiMap() { return midi_map; }
+	VSTFX_SysEx *getSysEx() { return sysex; }
+	float getSampleRate() { return sample_rate; }
+	const VSTFX_Transport &getTransport() const { return dsp->transport; }
+	VSTFX_VoiceEngine *getVoiceEngine() { return &dsp->voices; }
+	VSTFX_Sampler *getSampler() { return sampler; }
+
 	intptr_t dispatch(Vst::VstOpcodeToPlugin opcode, int32_t index,
 					  intptr_t value, void *ptr, float opt);
 
@@ -59,18 +214,72 @@ public:
 	float static callGetParameter(Vst::AEffect *effect, int32_t index);
 
 protected:
+	// the voices, the sampler and the mix into the outputs of a layout
+	template <VSTFX_OutputLayout L, VSTFX_Quality Q>
+	void render(float **outputs, int32_t frames);
+
+	/*!
+	 * \brief Applies one channel message, from the host or from the
+	 * queue. A note on takes `serial`, or a new one if that is 0.
+	 */
+	void handleMidi(const char *data, uint32_t serial = 0);
+
+	// a serial for a note on, see VSTFX_PendingEvent
+	uint32_t newNoteSerial();
+
+	// handles the queued messages due at or before `now`
+	void dispatchPending(int64_t now);
+
+	// MIDI learned values into the parameters, controllers already show
+	// what they sent
+	void applyMidiMap();
+
+	// controller feedback for parameters the host or the editor moved
+	void sendFeedback();
+
+	// render() for the current layout
+	template <VSTFX_Quality Q>
+	void renderLayout(float **outputs, int32_t frames);
+
 	Vst::AEffect effect{0};
+	Vst::AudioMasterCallbackFunc audioMaster{NULL};
 
 #ifdef WITH_GUI
-	VSTFX_GUI *editor;
+	// created on the first effEditOpen
+	VSTFX_GUI *editor{NULL};
+	Vst::ERect editor_rect{0, 0, VSTFX_EDITOR_HEIGHT, VSTFX_EDITOR_WIDTH};
 #endif
 
 	float sample_rate{44100.0};
 
-	// DSP
-	float freq, vol, phase;
-	float fGain{.5}, fRelease{0.0};
-	float timer;
+#ifdef WITH_MULTI_OUT
+	VSTFX_OutputLayout layout{VSTFX_OUTPUT_MULTI};
+#else
+	VSTFX_OutputLayout layout{VSTFX_OUTPUT_STEREO};
+#endif
+
+	bool precision64{false}; // the host asked for 64 bit processing
+
+	// one allocation, each object on lines of its own: what the audio
+	// thread writes, what the host and the editor write, the levels the
+	// editor reads, then the objects both sides use, each padding its
+	// members apart by the thread that writes them
+	VSTFX_Arena arena;
+	VSTFX_DspState *dsp;
+	VSTFX_Params *params;
+	VSTFX_Meter *meter;
+
+	// plays the notes instead of the voices once a library is loaded
+	VSTFX_Sampler *sampler;
+
+	// controllers, NRPNs and pitch bend to parameters
+	VSTFX_MidiMap *midi_map;
+
+	// patch and bank dumps, parsed in idle()
+	VSTFX_SysEx *sysex;
+
+	// output visualization
+	VSTFX_AudioTap *tap;
 };
 
 #endif
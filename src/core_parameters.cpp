@@ -0,0 +1,255 @@
+#include "core_parameters.hpp"
+#include "dsp/filter.hpp"
+#include "dsp/oscillator.hpp"
+#include "dsp/transport.hpp"
+#include "dsp/voice_alloc.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// -------- Parameter table --------
+
+constexpr const char *filterTypeNames[VSTFX_FILTER_TYPE_COUNT] = {
+	"Off", "SVF", "Ladder"};
+constexpr const char *waveformNames[VSTFX_WAVE_COUNT] = {"Sine", "Saw"};
+constexpr const char *voiceModeNames[VSTFX_VOICE_MODE_COUNT] = {
+	"Poly", "Mono", "Legato"};
+constexpr const char *stealPolicyNames[VSTFX_STEAL_POLICY_COUNT] = {
+	"Oldest", "Quietest", "Same note", "Softest"};
+
+// Adding a parameter: add its ID to core_parameters.hpp and a row here, in
+// the same order. Everything else (host queries, display, parsing, editor
+// knobs) is generated from this table.
+constexpr VSTFX_ParamDesc paramTable[PARAMETER_COUNT] = {
+	// id, name, label, min, max, default, curve, format, decimals, scale, flags
+	{kVolume, "Gain", "dB", 0.0f, 1.0f, 0.5f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_DB, 1, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kRelease, "Release", "ms", 0.0f, 1.0f, 0.0f, VSTFX_CURVE_INVERTED,
+	 VSTFX_FORMAT_DECAY_MS, 0, 0.8f, VSTFX_PARAM_AUTOMATABLE},
+	{kLfoRate, "LFO Rate", "", 0.0f, VSTFX_DIVISION_COUNT - 1, VSTFX_DIV_1_4,
+	 VSTFX_CURVE_LINEAR, VSTFX_FORMAT_DIVISION, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER},
+	{kLfoDepth, "LFO Depth", "%", 0.0f, 1.0f, 0.0f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kDelayTime, "Delay", "", 0.0f, VSTFX_DIVISION_COUNT - 1, VSTFX_DIV_1_8D,
+	 VSTFX_CURVE_LINEAR, VSTFX_FORMAT_DIVISION, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER},
+	{kDelayFeedback, "Feedback", "%", 0.0f, 0.95f, 0.35f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kDelayMix, "Delay Mix", "%", 0.0f, 1.0f, 0.0f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kFilterType, "Filter", "", 0.0f, VSTFX_FILTER_TYPE_COUNT - 1,
+	 VSTFX_FILTER_OFF, VSTFX_CURVE_LINEAR, VSTFX_FORMAT_CHOICE, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER, filterTypeNames},
+	{kCutoff, "Cutoff", "Hz", 20.0f, 20000.0f, 20000.0f, VSTFX_CURVE_EXP,
+	 VSTFX_FORMAT_NUMBER, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kResonance, "Resonance", "%", 0.0f, 1.0f, 0.0f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kWaveform, "Wave", "", 0.0f, VSTFX_WAVE_COUNT - 1, VSTFX_WAVE_SINE,
+	 VSTFX_CURVE_LINEAR, VSTFX_FORMAT_CHOICE, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER, waveformNames},
+	{kUnison, "Unison", "", 1.0f, VSTFX_MAX_UNISON, 1.0f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_NUMBER, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER},
+	{kDetune, "Detune", "%", 0.0f, 1.0f, 0.3f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kSpread, "Spread", "%", 0.0f, 1.0f, 0.5f, VSTFX_CURVE_LINEAR,
+	 VSTFX_FORMAT_PERCENT, 0, 1.0f, VSTFX_PARAM_AUTOMATABLE},
+	{kVoiceMode, "Voices", "", 0.0f, VSTFX_VOICE_MODE_COUNT - 1,
+	 VSTFX_VOICE_POLY, VSTFX_CURVE_LINEAR, VSTFX_FORMAT_CHOICE, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER, voiceModeNames},
+	{kSteal, "Steal", "", 0.0f, VSTFX_STEAL_POLICY_COUNT - 1,
+	 VSTFX_STEAL_OLDEST, VSTFX_CURVE_LINEAR, VSTFX_FORMAT_CHOICE, 0, 1.0f,
+	 VSTFX_PARAM_AUTOMATABLE | VSTFX_PARAM_INTEGER, stealPolicyNames},
+};
+
+constexpr bool ParamTableIsOrdered() {
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		if (paramTable[i].id != i) return false;
+	}
+	return true;
+}
+static_assert(ParamTableIsOrdered(), "paramTable rows must follow the IDs");
+
+// -------- Parameter values --------
+
+VSTFX_Params::VSTFX_Params() {
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		plain_values[i] = paramTable[i].def;
+		normalized[i] = ToNormalized(i, paramTable[i].def);
+	}
+}
+
+void VSTFX_Params::set(int32_t index, float value) {
+	if (value < 0.0f) value = 0.0f;
+	if (value > 1.0f) value = 1.0f;
+	normalized[index] = value;
+	plain_values[index] = ToPlain(index, value);
+}
+
+// -------- Curves --------
+
+float VSTFX_Params::ToPlain(int32_t index, float n) {
+	const VSTFX_ParamDesc &p = paramTable[index];
+
+	if (p.flags & VSTFX_PARAM_SWITCH) return n < 0.5f ? p.min : p.max;
+
+	float v;
+	switch (p.curve) {
+		case VSTFX_CURVE_INVERTED:
+			v = p.max - (p.max - p.min) * n;
+			break;
+		case VSTFX_CURVE_EXP:
+			v = p.min * powf(p.max / p.min, n);
+			break;
+		default:
+			v = p.min + (p.max - p.min) * n;
+			break;
+	}
+
+	if (p.flags & VSTFX_PARAM_INTEGER) v = floorf(v + 0.5f);
+	return v;
+}
+
+float VSTFX_Params::ToNormalized(int32_t index, float v) {
+	const VSTFX_ParamDesc &p = paramTable[index];
+
+	if (v < p.min) v = p.min;
+	if (v > p.max) v = p.max;
+	if (p.max == p.min) return 0.0f;
+
+	switch (p.curve) {
+		case VSTFX_CURVE_INVERTED:
+			return (p.max - v) / (p.max - p.min);
+		case VSTFX_CURVE_EXP:
+			return logf(v / p.min) / logf(p.max / p.min);
+		default:
+			return (v - p.min) / (p.max - p.min);
+	}
+}
+
+// -------- Display --------
+
+void VSTFX_Params::Format(int32_t index, float v, char *text) {
+	const VSTFX_ParamDesc &p = paramTable[index];
+	const size_t len = Vst::kVstMaxParamStrLen;
+
+	if (p.flags & VSTFX_PARAM_SWITCH) {
+		snprintf(text, len, "%s", v > p.min ? "On" : "Off");
+		return;
+	}
+
+	switch (p.format) {
+		case VSTFX_FORMAT_DB:
+			if (v <= 0.0f) {
+				snprintf(text, len, "-inf");
+			} else {
+				snprintf(text, len, "%.*f", p.decimals, 20.0f * log10f(v));
+			}
+			break;
+		case VSTFX_FORMAT_DECAY_MS:
+			if (v <= 0.0f) {
+				snprintf(text, len, "inf");
+			} else {
+				snprintf(text, len, "%.*f", p.decimals,
+						 1000.0f * p.display_scale / v);
+			}
+			break;
+		case VSTFX_FORMAT_PERCENT:
+			snprintf(text, len, "%.*f", p.decimals, 100.0f * v);
+			break;
+		case VSTFX_FORMAT_DIVISION:
+			snprintf(text, len, "%s", divisionTable[(int32_t)v].name);
+			break;
+		case VSTFX_FORMAT_CHOICE:
+			snprintf(text, len, "%s", p.choices[(int32_t)v]);
+			break;
+		default:
+			snprintf(text, len, "%.*f", p.decimals, v);
+			break;
+	}
+}
+
+bool VSTFX_Params::Parse(int32_t index, const char *text, float *v) {
+	const VSTFX_ParamDesc &p = paramTable[index];
+
+	if (p.flags & VSTFX_PARAM_SWITCH) {
+		if (!strcmp(text, "On")) {
+			*v = p.max;
+			return true;
+		}
+		if (!strcmp(text, "Off")) {
+			*v = p.min;
+			return true;
+		}
+	}
+
+	if (p.format == VSTFX_FORMAT_DIVISION) {
+		for (int32_t i = 0; i < VSTFX_DIVISION_COUNT; i++) {
+			if (strcmp(text, divisionTable[i].name)) continue;
+			*v = (float)i;
+			return true;
+		}
+		return false;
+	}
+
+	if (p.format == VSTFX_FORMAT_CHOICE) {
+		for (int32_t i = 0; i <= (int32_t)p.max; i++) {
+			if (strcmp(text, p.choices[i])) continue;
+			*v = (float)i;
+			return true;
+		}
+		return false;
+	}
+
+	char *end;
+	float x = strtof(text, &end);
+	bool is_inf = !strcmp(text, "inf") || !strcmp(text, "-inf");
+	if (end == text && !is_inf) return false;
+
+	switch (p.format) {
+		case VSTFX_FORMAT_DB:
+			*v = is_inf ? 0.0f : powf(10.0f, x / 20.0f);
+			break;
+		case VSTFX_FORMAT_DECAY_MS:
+			*v = (is_inf || x <= 0.0f) ? 0.0f
+									   : 1000.0f * p.display_scale / x;
+			break;
+		case VSTFX_FORMAT_PERCENT:
+			*v = x / 100.0f;
+			break;
+		default:
+			*v = x;
+			break;
+	}
+	return true;
+}
+
+void VSTFX_Params::GetProperties(int32_t index,
+								 Vst::VstParameterProperties *props) {
+	const VSTFX_ParamDesc &p = paramTable[index];
+	memset(props, 0, sizeof(*props));
+
+	snprintf(props->label, Vst::kVstMaxLabelLen, "%s", p.name);
+	snprintf(props->shortLabel, Vst::kVstMaxShortLabelLen, "%s", p.name);
+	props->displayIndex = (int16_t)index;
+
+	int32_t flags = Vst::kVstParameterSupportsDisplayIndex;
+	if (p.flags & VSTFX_PARAM_SWITCH) {
+		flags |= Vst::kVstParameterIsSwitch;
+	} else if (p.flags & VSTFX_PARAM_INTEGER) {
+		flags |= Vst::kVstParameterUsesIntegerMinMax |
+				 Vst::kVstParameterUsesIntStep;
+		props->minInteger = (int32_t)p.min;
+		props->maxInteger = (int32_t)p.max;
+		props->stepInteger = 1;
+		props->largeStepInteger = 1;
+	} else {
+		flags |= Vst::kVstParameterUsesFloatStep | Vst::kVstParameterCanRamp;
+		props->stepFloat = 0.01f;
+		props->smallStepFloat = 0.001f;
+		props->largeStepFloat = 0.1f;
+	}
+	props->flags = (Vst::VstParameterFlags)flags;
+}
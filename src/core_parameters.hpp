@@ -1,11 +1,121 @@
 #ifndef VSTFX_COREPARAMS_H
 #define VSTFX_COREPARAMS_H
 
+#include "vst.h"
+#include <bitset>
+#include <cstdint>
+
 enum {
     kVolume = 0,
     kRelease,
+    kLfoRate,
+    kLfoDepth,
+    kDelayTime,
+    kDelayFeedback,
+    kDelayMix,
+    kFilterType,
+    kCutoff,
+    kResonance,
+    kWaveform,
+    kUnison,
+    kDetune,
+    kSpread,
+    kVoiceMode,
+    kSteal,
 
     PARAMETER_COUNT
 };
 
+// one bit per parameter, however many there are
+typedef std::bitset<PARAMETER_COUNT> VSTFX_ParamMask;
+
+// -------- Parameter descriptors --------
+
+// maps the host's normalized 0..1 value to plain units
+enum VSTFX_ParamCurve {
+	VSTFX_CURVE_LINEAR = 0, // min at 0, max at 1
+	VSTFX_CURVE_INVERTED,	// max at 0, min at 1
+	VSTFX_CURVE_EXP			// equal ratios per step, min must be > 0
+};
+
+// how plain values are shown to and parsed from the host
+enum VSTFX_ParamFormat {
+	VSTFX_FORMAT_NUMBER = 0, // plain value as is
+	VSTFX_FORMAT_DB,		 // linear gain shown in dB
+	VSTFX_FORMAT_DECAY_MS,	 // decay rate per second shown as time to silence
+	VSTFX_FORMAT_PERCENT,	 // 0..1 shown as 0..100
+	VSTFX_FORMAT_DIVISION,	 // index into divisionTable, shown as a note length
+	VSTFX_FORMAT_CHOICE		 // index into the descriptor's choices
+};
+
+enum VSTFX_ParamFlags {
+	VSTFX_PARAM_AUTOMATABLE = 1 << 0,
+	VSTFX_PARAM_SWITCH = 1 << 1, // two states, off below 0.5
+	VSTFX_PARAM_INTEGER = 1 << 2 // plain value snaps to whole numbers
+};
+
+struct VSTFX_ParamDesc {
+	int32_t id;
+	const char *name;  // effGetParamName
+	const char *label; // effGetParamLabel, units
+
+	float min, max, def; // plain units
+	VSTFX_ParamCurve curve;
+
+	VSTFX_ParamFormat format;
+	int32_t decimals;
+	float display_scale; // format specific, e.g. level for DECAY_MS
+
+	int32_t flags;
+
+	// VSTFX_FORMAT_CHOICE only, max + 1 names
+	const char *const *choices = NULL;
+};
+
+// one row per parameter, indexed by ID, in core_parameters.cpp
+extern const VSTFX_ParamDesc paramTable[PARAMETER_COUNT];
+
+// -------- Parameter values --------
+
+/*!
+ * \brief Normalized and plain values of every parameter, indexed by ID.
+ *
+ * Both are stored so that neither the host nor the DSP pays for a curve
+ * conversion on read.
+ */
+class VSTFX_Params {
+public:
+	VSTFX_Params();
+
+	void set(int32_t index, float normalized);
+	float get(int32_t index) const { return normalized[index]; }
+	float plain(int32_t index) const { return plain_values[index]; }
+
+	// conversions, valid for any value
+	static float ToPlain(int32_t index, float normalized);
+	static float ToNormalized(int32_t index, float plain);
+
+	/*!
+	 * \brief Writes the display text for a plain value, at most
+	 * kVstMaxParamStrLen characters.
+	 */
+	static void Format(int32_t index, float plain, char *text);
+
+	/*!
+	 * \brief Parses display text back into a plain value.
+	 */
+	static bool Parse(int32_t index, const char *text, float *plain);
+
+	static void GetProperties(int32_t index,
+							  Vst::VstParameterProperties *props);
+
+	static bool IsValid(int32_t index) {
+		return index >= 0 && index < PARAMETER_COUNT;
+	}
+
+private:
+	float normalized[PARAMETER_COUNT];
+	float plain_values[PARAMETER_COUNT];
+};
+
 #endif
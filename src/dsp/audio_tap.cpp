@@ -0,0 +1,22 @@
+#include "audio_tap.hpp"
+
+void VSTFX_AudioTap::pushDecimated(const float *samples, int32_t count) {
+	// decimate into a small stack buffer, then publish it in one go
+	float block[256];
+	int n = 0;
+
+	for (int32_t i = 0; i < count; i++) {
+		acc += samples[i];
+		if (++acc_count < VSTFX_TAP_DECIMATION) continue;
+
+		block[n++] = acc * (1.0f / VSTFX_TAP_DECIMATION);
+		acc = 0.0f;
+		acc_count = 0;
+
+		if (n == 256) {
+			ring.push(block, n);
+			n = 0;
+		}
+	}
+	if (n) ring.push(block, n);
+}
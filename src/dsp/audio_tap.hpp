@@ -0,0 +1,53 @@
+#ifndef VSTFX_AUDIO_TAP_H
+#define VSTFX_AUDIO_TAP_H
+
+#include "../util/spsc_ring.hpp"
+#include <cstdint>
+
+// the editor sees every n-th (averaged) output sample
+#define VSTFX_TAP_DECIMATION 2
+#define VSTFX_TAP_CAPACITY 16384
+
+/*!
+ * \brief Hands decimated output audio from the audio thread to the editor.
+ *
+ * While no editor is open, push() is a single relaxed load and a branch.
+ */
+class VSTFX_AudioTap {
+public:
+	// -------- Audio thread --------
+
+	void push(const float *samples, int32_t count) {
+		if (!enabled.load(std::memory_order_relaxed)) return;
+		pushDecimated(samples, count);
+	}
+
+	// -------- Editor thread --------
+
+	void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+	/*!
+	 * \brief Moves up to `max` decimated samples into `dst`, returns how
+	 * many were read.
+	 */
+	size_t drain(float *dst, size_t max) { return ring.pop(dst, max); }
+
+	float sampleRate(float host_rate) const {
+		return host_rate / VSTFX_TAP_DECIMATION;
+	}
+
+private:
+	void pushDecimated(const float *samples, int32_t count);
+
+	// written by the editor, a line apart from what push() writes
+	std::atomic<bool> enabled{false};
+	char pad_editor[VSTFX_CACHE_LINE];
+
+	// decimator state, audio thread only
+	float acc{0.0f};
+	int acc_count{0};
+
+	VSTFX_SpscRing<float, VSTFX_TAP_CAPACITY> ring;
+};
+
+#endif
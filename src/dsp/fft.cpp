@@ -0,0 +1,74 @@
+#include "fft.hpp"
+
+#include "../util/asset_cache.hpp"
+#include <cmath>
+#include <string>
+
+#define PI 3.1415926535897
+
+VSTFX_FFTTables::VSTFX_FFTTables(int n)
+	: window(n), tw_cos(n / 2), tw_sin(n / 2), bitrev(n) {
+	int bits = 0;
+	while ((1 << bits) < n)
+		bits++;
+
+	for (int i = 0; i < n; i++) {
+		int r = 0;
+		for (int b = 0; b < bits; b++)
+			r |= ((i >> b) & 1) << (bits - 1 - b);
+		bitrev[i] = r;
+
+		window[i] = 0.5f - 0.5f * (float)cos(2 * PI * i / (n - 1));
+	}
+
+	for (int i = 0; i < n / 2; i++) {
+		tw_cos[i] = (float)cos(2 * PI * i / n);
+		tw_sin[i] = (float)-sin(2 * PI * i / n);
+	}
+}
+
+VSTFX_FFT::VSTFX_FFT(int size) : n(size), re(size), im(size) {
+	tables = VSTFX_AssetCache::Get<VSTFX_FFTTables>(
+		"fft/" + std::to_string(size),
+		[=] { return new VSTFX_FFTTables(size); });
+}
+
+void VSTFX_FFT::transform() {
+	const float *tw_cos = tables->tw_cos.data();
+	const float *tw_sin = tables->tw_sin.data();
+
+	for (int len = 2; len <= n; len <<= 1) {
+		int half = len >> 1;
+		int step = n / len;
+		for (int start = 0; start < n; start += len) {
+			for (int k = 0; k < half; k++) {
+				float wr = tw_cos[k * step], wi = tw_sin[k * step];
+				int a = start + k, b = a + half;
+				float xr = re[b] * wr - im[b] * wi;
+				float xi = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - xr;
+				im[b] = im[a] - xi;
+				re[a] += xr;
+				im[a] += xi;
+			}
+		}
+	}
+}
+
+void VSTFX_FFT::magnitudes(const float *in, float *out_db) {
+	const std::vector<int> &bitrev = tables->bitrev;
+	const std::vector<float> &window = tables->window;
+	for (int i = 0; i < n; i++) {
+		re[bitrev[i]] = in[i] * window[i];
+		im[bitrev[i]] = 0.0f;
+	}
+
+	transform();
+
+	// Hann window has a coherent gain of 0.5
+	float scale = 4.0f / n;
+	for (int i = 0; i < n / 2; i++) {
+		float mag = sqrtf(re[i] * re[i] + im[i] * im[i]) * scale;
+		out_db[i] = 20.0f * log10f(mag + 1e-9f);
+	}
+}
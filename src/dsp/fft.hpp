@@ -0,0 +1,45 @@
+#ifndef VSTFX_FFT_H
+#define VSTFX_FFT_H
+
+#include <memory>
+#include <vector>
+
+// window, twiddles and bit reversal, shared by every FFT of a size
+struct VSTFX_FFTTables {
+	explicit VSTFX_FFTTables(int size);
+
+	std::vector<float> window;
+	std::vector<float> tw_cos, tw_sin;
+	std::vector<int> bitrev;
+};
+
+/*!
+ * \brief Radix-2 FFT for analysis display.
+ *
+ * Window, twiddles and bit-reversal table are computed once per size for
+ * the whole module, and the workspace is reused, so magnitudes() never
+ * allocates.
+ */
+class VSTFX_FFT {
+public:
+	explicit VSTFX_FFT(int size);
+
+	int size() const { return n; }
+
+	/*!
+	 * \brief Hann-windowed magnitude spectrum of `in` (size() samples) in
+	 * dBFS, written to `out_db` (size() / 2 bins).
+	 */
+	void magnitudes(const float *in, float *out_db);
+
+private:
+	int n;
+	std::shared_ptr<const VSTFX_FFTTables> tables;
+
+	// workspace
+	std::vector<float> re, im;
+
+	void transform();
+};
+
+#endif
@@ -0,0 +1,226 @@
+#include "filter.hpp"
+#include "../util/asset_cache.hpp"
+#include "../util/simd.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+#define TABLE_LAST (VSTFX_FILTER_OCTAVES * VSTFX_FILTER_STEPS)
+
+// keeps both models just short of self oscillation
+#define MAX_RESONANCE 0.98f
+
+VSTFX_VoiceFilter::VSTFX_VoiceFilter() { setSampleRate(44100.0f); }
+
+static VSTFX_CutoffTable *BuildCutoffTable(float sample_rate) {
+	const double pi = 3.141592653589793;
+	double nyquist_limit = 0.49 * sample_rate;
+
+	VSTFX_CutoffTable *t = new VSTFX_CutoffTable;
+	for (int32_t i = 0; i <= TABLE_LAST; i++) {
+		double hz = VSTFX_FILTER_MIN_HZ *
+					pow(2.0, (double)i / VSTFX_FILTER_STEPS);
+		if (hz > nyquist_limit) hz = nyquist_limit;
+		t->gain[i] = (float)tan(pi * hz / sample_rate);
+	}
+	return t;
+}
+
+void VSTFX_VoiceFilter::setSampleRate(float sample_rate) {
+	char key[64];
+	snprintf(key, sizeof(key), "filter.cutoff/%.3f", sample_rate);
+	table = VSTFX_AssetCache::Get<VSTFX_CutoffTable>(
+		key, [=] { return BuildCutoffTable(sample_rate); });
+}
+
+float VSTFX_VoiceFilter::gain(float octaves) const {
+	float pos = octaves * VSTFX_FILTER_STEPS;
+	const float *g = table->gain;
+	if (pos <= 0.0f) return g[0];
+	if (pos >= TABLE_LAST) return g[TABLE_LAST];
+
+	int32_t i = (int32_t)pos;
+	float frac = pos - i;
+	return g[i] + (g[i + 1] - g[i]) * frac;
+}
+
+void VSTFX_VoiceFilter::process(VSTFX_FilterType type,
+								VSTFX_FilterState **states, float *lanes,
+								int32_t frames, int32_t block,
+								const float *cutoff, float resonance) const {
+	if (resonance < 0.0f) resonance = 0.0f;
+	if (resonance > 1.0f) resonance = 1.0f;
+	resonance *= MAX_RESONANCE;
+
+	switch (type) {
+		case VSTFX_FILTER_SVF:
+			processSvf(states, lanes, frames, block, cutoff, resonance);
+			break;
+		case VSTFX_FILTER_LADDER:
+			processLadder(states, lanes, frames, block, cutoff, resonance);
+			break;
+		default:
+			break;
+	}
+}
+
+// -------- Lane helpers --------
+
+// one float per lane from each state's channel, and back
+static VSTFX_Float4 Gather(VSTFX_FilterState **states, int32_t ch,
+						   int32_t j) {
+	float x[VSTFX_FILTER_LANES];
+	for (int32_t l = 0; l < VSTFX_FILTER_LANES; l++)
+		x[l] = states[l]->s[ch][j];
+	return VSTFX_Float4::load(x);
+}
+
+static void Scatter(VSTFX_FilterState **states, int32_t ch, int32_t j,
+					VSTFX_Float4 v) {
+	float x[VSTFX_FILTER_LANES];
+	v.store(x);
+	for (int32_t l = 0; l < VSTFX_FILTER_LANES; l++)
+		states[l]->s[ch][j] = x[l];
+}
+
+// Moves each lane's coefficients on to `end` and returns where they were
+// and the per sample step towards `end`, as lanes.
+static void Ramp(VSTFX_FilterState **states, float end[][VSTFX_FILTER_LANES],
+				 int32_t count, int32_t n, VSTFX_Float4 *start,
+				 VSTFX_Float4 *step) {
+	float from[3][VSTFX_FILTER_LANES];
+	for (int32_t l = 0; l < VSTFX_FILTER_LANES; l++) {
+		VSTFX_FilterState *st = states[l];
+		for (int32_t j = 0; j < count; j++) {
+			// a new voice starts at its target instead of sweeping to it
+			from[j][l] = st->primed ? st->c[j] : end[j][l];
+			st->c[j] = end[j][l];
+		}
+		st->primed = true;
+	}
+
+	VSTFX_Float4 inv_n(1.0f / n);
+	for (int32_t j = 0; j < count; j++) {
+		start[j] = VSTFX_Float4::load(from[j]);
+		step[j] = (VSTFX_Float4::load(end[j]) - start[j]) * inv_n;
+	}
+}
+
+// -------- State variable filter --------
+
+// topology preserving SVF, lowpass output
+void VSTFX_VoiceFilter::processSvf(VSTFX_FilterState **states, float *lanes,
+								   int32_t frames, int32_t block,
+								   const float *cutoff,
+								   float resonance) const {
+	float k = 2.0f - 2.0f * resonance;
+	VSTFX_Float4 ic1[VSTFX_FILTER_CHANNELS], ic2[VSTFX_FILTER_CHANNELS];
+	for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++) {
+		ic1[ch] = Gather(states, ch, 0);
+		ic2[ch] = Gather(states, ch, 1);
+	}
+
+	for (int32_t start = 0, sb = 0; start < frames; start += block, sb++) {
+		int32_t n = frames - start;
+		if (n > block) n = block;
+
+		float end[3][VSTFX_FILTER_LANES];
+		for (int32_t l = 0; l < VSTFX_FILTER_LANES; l++) {
+			float g = gain(cutoff[sb * VSTFX_FILTER_LANES + l]);
+			float a1 = 1.0f / (1.0f + g * (g + k));
+			end[0][l] = a1;
+			end[1][l] = g * a1;
+			end[2][l] = g * g * a1;
+		}
+
+		VSTFX_Float4 a[3], da[3];
+		Ramp(states, end, 3, n, a, da);
+
+		float *p = lanes + start * VSTFX_FILTER_FRAME;
+		for (int32_t i = 0; i < n; i++, p += VSTFX_FILTER_FRAME) {
+			for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++) {
+				float *q = p + ch * VSTFX_FILTER_LANES;
+				VSTFX_Float4 v0 = VSTFX_Float4::load(q);
+				VSTFX_Float4 v3 = v0 - ic2[ch];
+				VSTFX_Float4 v1 = a[0] * ic1[ch] + a[1] * v3;
+				VSTFX_Float4 v2 = ic2[ch] + a[1] * ic1[ch] + a[2] * v3;
+				ic1[ch] = v1 + v1 - ic1[ch];
+				ic2[ch] = v2 + v2 - ic2[ch];
+				v2.store(q);
+			}
+
+			a[0] += da[0];
+			a[1] += da[1];
+			a[2] += da[2];
+		}
+	}
+
+	for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++) {
+		Scatter(states, ch, 0, ic1[ch]);
+		Scatter(states, ch, 1, ic2[ch]);
+	}
+}
+
+// -------- Ladder --------
+
+// four TPT one-poles with the feedback loop solved without a unit delay
+void VSTFX_VoiceFilter::processLadder(VSTFX_FilterState **states,
+									  float *lanes, int32_t frames,
+									  int32_t block, const float *cutoff,
+									  float resonance) const {
+	VSTFX_Float4 k(4.0f * resonance), one(1.0f);
+	VSTFX_Float4 s[VSTFX_FILTER_CHANNELS][4];
+	for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++)
+		for (int32_t j = 0; j < 4; j++)
+			s[ch][j] = Gather(states, ch, j);
+
+	for (int32_t start = 0, sb = 0; start < frames; start += block, sb++) {
+		int32_t n = frames - start;
+		if (n > block) n = block;
+
+		float end[1][VSTFX_FILTER_LANES];
+		for (int32_t l = 0; l < VSTFX_FILTER_LANES; l++) {
+			float g = gain(cutoff[sb * VSTFX_FILTER_LANES + l]);
+			end[0][l] = g / (1.0f + g);
+		}
+
+		VSTFX_Float4 G, dG;
+		Ramp(states, end, 1, n, &G, &dG);
+
+		float *p = lanes + start * VSTFX_FILTER_FRAME;
+		for (int32_t i = 0; i < n; i++, p += VSTFX_FILTER_FRAME) {
+			// each stage is y = G * in + (1 - G) * s
+			VSTFX_Float4 h = one - G;
+			VSTFX_Float4 G2 = G * G, G4 = G2 * G2;
+			VSTFX_Float4 norm = one / (one + k * G4);
+
+			for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++) {
+				float *q = p + ch * VSTFX_FILTER_LANES;
+				VSTFX_Float4 *st = s[ch];
+				VSTFX_Float4 x = VSTFX_Float4::load(q);
+
+				VSTFX_Float4 sum =
+					G * (G * (G * (st[0] * h) + st[1] * h) + st[2] * h) +
+					st[3] * h;
+				VSTFX_Float4 y4 = (G4 * x + sum) * norm;
+
+				VSTFX_Float4 u = x - k * y4;
+				VSTFX_Float4 v = (u - st[0]) * G, y = v + st[0];
+				st[0] = y + v;
+				v = (y - st[1]) * G, y = v + st[1];
+				st[1] = y + v;
+				v = (y - st[2]) * G, y = v + st[2];
+				st[2] = y + v;
+				v = (y - st[3]) * G, y = v + st[3];
+				st[3] = y + v;
+				y.store(q);
+			}
+
+			G += dG;
+		}
+	}
+
+	for (int32_t ch = 0; ch < VSTFX_FILTER_CHANNELS; ch++)
+		for (int32_t j = 0; j < 4; j++)
+			Scatter(states, ch, j, s[ch][j]);
+}
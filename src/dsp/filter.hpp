@@ -0,0 +1,94 @@
+#ifndef VSTFX_FILTER_H
+#define VSTFX_FILTER_H
+
+#include <cstdint>
+#include <memory>
+
+// voices filtered side by side, one per SIMD lane
+#define VSTFX_FILTER_LANES 4
+
+// each voice is filtered in left and right, one SIMD vector per channel
+#define VSTFX_FILTER_CHANNELS 2
+#define VSTFX_FILTER_FRAME (VSTFX_FILTER_CHANNELS * VSTFX_FILTER_LANES)
+
+// cutoff table range: octaves above VSTFX_FILTER_MIN_HZ
+#define VSTFX_FILTER_MIN_HZ 20.0f
+#define VSTFX_FILTER_OCTAVES 10
+#define VSTFX_FILTER_STEPS 64 // table entries per octave
+
+// cutoff shift for a cutoff modulation of 1
+#define VSTFX_FILTER_MOD_OCTAVES 5.0f
+
+enum VSTFX_FilterType {
+	VSTFX_FILTER_OFF = 0,
+	VSTFX_FILTER_SVF,	 // 12 dB/oct state variable lowpass
+	VSTFX_FILTER_LADDER, // 24 dB/oct ladder lowpass
+
+	VSTFX_FILTER_TYPE_COUNT
+};
+
+/*!
+ * \brief Per-voice filter memory. Both channels share the coefficients.
+ */
+struct VSTFX_FilterState {
+	float s[VSTFX_FILTER_CHANNELS][4]; // integrator states, the SVF uses two
+	float c[3]; // coefficients reached at the end of the last sub-block
+	bool primed; // false until the first sub-block has set c
+
+	void reset() {
+		for (float *ch : s)
+			for (int32_t j = 0; j < 4; j++)
+				ch[j] = 0.0f;
+		primed = false;
+	}
+};
+
+// tan(pi * fc / fs) per table step, shared by instances at the same rate
+struct VSTFX_CutoffTable {
+	float gain[VSTFX_FILTER_OCTAVES * VSTFX_FILTER_STEPS + 1];
+};
+
+/*!
+ * \brief Resonant lowpass for VSTFX_FILTER_LANES stereo voices at a time.
+ *
+ * Cutoffs are looked up in a tan() table built for the sample rate, once
+ * per sub-block and lane, and the resulting coefficients are ramped
+ * linearly across the sub-block. Nothing transcendental runs per sample.
+ */
+class VSTFX_VoiceFilter {
+public:
+	VSTFX_VoiceFilter();
+
+	// picks the cutoff table for the rate, not for the audio thread
+	void setSampleRate(float sample_rate);
+
+	/*!
+	 * \brief Filters `lanes` in place: `frames` samples of
+	 * VSTFX_FILTER_LANES interleaved voices, all lanes' left samples
+	 * followed by all lanes' right samples for each frame.
+	 *
+	 * `cutoff` holds each lane's cutoff, in octaves above
+	 * VSTFX_FILTER_MIN_HZ, for the end of every `block` samples, lane
+	 * minor. `states` has one entry per lane.
+	 */
+	void process(VSTFX_FilterType type, VSTFX_FilterState **states,
+				 float *lanes, int32_t frames, int32_t block,
+				 const float *cutoff, float resonance) const;
+
+	/*!
+	 * \brief Prewarped integrator gain, tan(pi * fc / fs).
+	 */
+	float gain(float octaves) const;
+
+private:
+	void processSvf(VSTFX_FilterState **states, float *lanes, int32_t frames,
+					int32_t block, const float *cutoff,
+					float resonance) const;
+	void processLadder(VSTFX_FilterState **states, float *lanes,
+					   int32_t frames, int32_t block, const float *cutoff,
+					   float resonance) const;
+
+	std::shared_ptr<const VSTFX_CutoffTable> table;
+};
+
+#endif
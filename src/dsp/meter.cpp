@@ -0,0 +1,98 @@
+#include "meter.hpp"
+#include "../util/simd.hpp"
+
+#include <cmath>
+
+void VSTFX_Meter::Reduce(const float *x, int32_t n, float *peak_out,
+						 float *sumsq_out) {
+	float pk = 0.0f, sum = 0.0f;
+	int32_t i = 0;
+
+#ifdef VSTFX_HAS_SSE
+	// four independent accumulators per reduction to hide add latency
+	__m128 zero = _mm_setzero_ps();
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 max0 = zero, max1 = zero, max2 = zero, max3 = zero;
+	__m128 sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+	for (; i + 16 <= n; i += 16) {
+		__m128 a = _mm_loadu_ps(x + i);
+		__m128 b = _mm_loadu_ps(x + i + 4);
+		__m128 c = _mm_loadu_ps(x + i + 8);
+		__m128 d = _mm_loadu_ps(x + i + 12);
+		max0 = _mm_max_ps(max0, _mm_andnot_ps(sign, a));
+		max1 = _mm_max_ps(max1, _mm_andnot_ps(sign, b));
+		max2 = _mm_max_ps(max2, _mm_andnot_ps(sign, c));
+		max3 = _mm_max_ps(max3, _mm_andnot_ps(sign, d));
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+		sum2 = _mm_add_ps(sum2, _mm_mul_ps(c, c));
+		sum3 = _mm_add_ps(sum3, _mm_mul_ps(d, d));
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, _mm_max_ps(_mm_max_ps(max0, max1),
+									_mm_max_ps(max2, max3)));
+	pk = fmaxf(fmaxf(lanes[0], lanes[1]), fmaxf(lanes[2], lanes[3]));
+	_mm_storeu_ps(lanes, _mm_add_ps(_mm_add_ps(sum0, sum1),
+									_mm_add_ps(sum2, sum3)));
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+
+	for (; i < n; i++) {
+		pk = fmaxf(pk, fabsf(x[i]));
+		sum += x[i] * x[i];
+	}
+
+	*peak_out = pk;
+	*sumsq_out = sum;
+}
+
+void VSTFX_Meter::process(float **outputs, int32_t channels,
+						  int32_t n) {
+	if (n <= 0) return;
+	if (channels > VSTFX_METER_CHANNELS) channels = VSTFX_METER_CHANNELS;
+
+	float pk[VSTFX_METER_CHANNELS], sq[VSTFX_METER_CHANNELS];
+	float loudest = 0.0f;
+	for (int32_t c = 0; c < channels; c++) {
+		Reduce(outputs[c], n, &pk[c], &sq[c]);
+		Hold(peak[c], pk[c]);
+		loudest = fmaxf(loudest, pk[c]);
+	}
+	Hold(vu, loudest);
+
+	// only this thread writes the totals, the sequence tells the editor
+	// when it read them halfway through
+	uint32_t s = seq.load(std::memory_order_relaxed);
+	seq.store(s + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int32_t c = 0; c < channels; c++) {
+		double total = sumsq[c].load(std::memory_order_relaxed);
+		sumsq[c].store(total + sq[c], std::memory_order_relaxed);
+	}
+	frames.store(frames.load(std::memory_order_relaxed) + n,
+				 std::memory_order_relaxed);
+	seq.store(s + 2, std::memory_order_release);
+}
+
+void VSTFX_Meter::read(float *peak_out, float *rms_out) {
+	double totals[VSTFX_METER_CHANNELS];
+	uint64_t total_frames;
+	uint32_t s;
+	do {
+		s = seq.load(std::memory_order_acquire);
+		for (int32_t c = 0; c < VSTFX_METER_CHANNELS; c++)
+			totals[c] = sumsq[c].load(std::memory_order_relaxed);
+		total_frames = frames.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((s & 1) || s != seq.load(std::memory_order_relaxed));
+
+	uint64_t n = total_frames - read_frames;
+	for (int32_t c = 0; c < VSTFX_METER_CHANNELS; c++) {
+		peak_out[c] = peak[c].exchange(0.0f, std::memory_order_relaxed);
+		double sum = totals[c] - read_sumsq[c];
+		rms_out[c] = n ? (float)sqrt(fmax(sum, 0.0) / n) : 0.0f;
+		read_sumsq[c] = totals[c];
+	}
+	read_frames = total_frames;
+}
@@ -0,0 +1,70 @@
+#ifndef VSTFX_METER_H
+#define VSTFX_METER_H
+
+#include <atomic>
+#include <cstdint>
+
+#define VSTFX_METER_CHANNELS 2
+
+/*!
+ * \brief Per-channel peak and RMS of the output, over everything played
+ * since the reader last looked.
+ *
+ * The audio thread holds the highest peak until a reader takes it, and
+ * adds every block to running sums of squares, so nothing between two
+ * editor frames or two host VU queries is lost. The editor and the host
+ * take their peaks separately and keep their own place in the sums.
+ * Ballistics (decay, hold) are left to the reader.
+ */
+class VSTFX_Meter {
+public:
+	// -------- Audio thread --------
+
+	void process(float **outputs, int32_t channels, int32_t frames);
+
+	// -------- Editor thread --------
+
+	/*!
+	 * \brief Peak and RMS of each channel since the last call, into
+	 * arrays of VSTFX_METER_CHANNELS.
+	 */
+	void read(float *peak_out, float *rms_out);
+
+	// -------- Host --------
+
+	/*!
+	 * \brief Loudest channel peak since the last call, as reported
+	 * through effGetVu.
+	 */
+	float getVu() { return vu.exchange(0.0f, std::memory_order_relaxed); }
+
+	/*!
+	 * \brief Absolute peak and sum of squares of a buffer.
+	 */
+	static void Reduce(const float *x, int32_t n, float *peak_out,
+					   float *sumsq_out);
+
+private:
+	// raises `held` to `value`, unless a reader took it in between
+	static void Hold(std::atomic<float> &held, float value) {
+		float cur = held.load(std::memory_order_relaxed);
+		while (value > cur &&
+			   !held.compare_exchange_weak(cur, value,
+										   std::memory_order_relaxed))
+			;
+	}
+
+	std::atomic<float> peak[VSTFX_METER_CHANNELS]{};
+	std::atomic<float> vu{0.0f};
+
+	// running totals, consistent under `seq`, odd while being written
+	std::atomic<uint32_t> seq{0};
+	std::atomic<double> sumsq[VSTFX_METER_CHANNELS]{};
+	std::atomic<uint64_t> frames{0};
+
+	// the editor's place in the totals
+	double read_sumsq[VSTFX_METER_CHANNELS]{};
+	uint64_t read_frames{0};
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "mod_matrix.hpp"
+
+const char *modSourceNames[VSTFX_MOD_SRC_COUNT] = {
+	"None", "Envelope", "LFO", "Velocity", "Mod wheel"};
+
+const char *modDestNames[VSTFX_MOD_DST_COUNT] = {"None", "Pitch", "Gain",
+												 "Release", "Cutoff"};
+
+VSTFX_ModMatrix::VSTFX_ModMatrix() {
+	for (int32_t i = 0; i < VSTFX_MOD_SLOTS; i++) {
+		slots[i] = {VSTFX_MOD_SRC_NONE, VSTFX_MOD_DST_NONE, 0.0f, false};
+		live[i] = slots[i];
+	}
+	compile();
+}
+
+bool VSTFX_ModMatrix::setSlot(int32_t index, const VSTFX_ModSlot &slot) {
+	if (index < 0 || index >= VSTFX_MOD_SLOTS) return false;
+	if (!edits.push({index, slot})) return false;
+	slots[index] = slot;
+	return true;
+}
+
+void VSTFX_ModMatrix::update() {
+	Edit edit;
+	bool changed = false;
+	while (edits.pop(edit)) {
+		live[edit.index] = edit.slot;
+		changed = true;
+	}
+	if (changed) compile();
+}
+
+void VSTFX_ModMatrix::compile() {
+	block_routes.count = 0;
+	audio_routes.count = 0;
+	audio_pitch = false;
+
+	for (int32_t i = 0; i < VSTFX_MOD_SLOTS; i++) {
+		const VSTFX_ModSlot &s = live[i];
+		if (!s.isActive()) continue;
+
+		VSTFX_ModRoutes &r = s.audio_rate ? audio_routes : block_routes;
+		r.source[r.count] = (uint8_t)s.source;
+		r.dest[r.count] = (uint8_t)s.dest;
+		r.amount[r.count] = s.amount;
+		r.count++;
+
+		if (s.audio_rate && s.dest == VSTFX_MOD_DST_PITCH) audio_pitch = true;
+	}
+}
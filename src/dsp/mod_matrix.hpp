@@ -0,0 +1,117 @@
+#ifndef VSTFX_MOD_MATRIX_H
+#define VSTFX_MOD_MATRIX_H
+
+#include "../util/spsc_ring.hpp"
+#include <cstdint>
+
+#define VSTFX_MOD_SLOTS 16
+
+// samples between block rate evaluations, ramped linearly in between
+#define VSTFX_MOD_BLOCK 16
+
+enum VSTFX_ModSource {
+	VSTFX_MOD_SRC_NONE = 0,
+	VSTFX_MOD_SRC_ENV,		// voice envelope, 0..1
+	VSTFX_MOD_SRC_LFO,		// tempo synced LFO, -1..1
+	VSTFX_MOD_SRC_VELOCITY, // note on velocity, 0..1
+	VSTFX_MOD_SRC_MODWHEEL, // CC 1, 0..1
+
+	VSTFX_MOD_SRC_COUNT
+};
+
+enum VSTFX_ModDest {
+	VSTFX_MOD_DST_NONE = 0,
+	VSTFX_MOD_DST_PITCH,   // octaves
+	VSTFX_MOD_DST_GAIN,	   // added to a gain of 1
+	VSTFX_MOD_DST_RELEASE, // added to a decay rate factor of 1
+	VSTFX_MOD_DST_CUTOFF,  // octaves, for the voice filter
+
+	VSTFX_MOD_DST_COUNT
+};
+
+extern const char *modSourceNames[VSTFX_MOD_SRC_COUNT];
+extern const char *modDestNames[VSTFX_MOD_DST_COUNT];
+
+struct VSTFX_ModSlot {
+	int32_t source;
+	int32_t dest;
+	float amount; // -1..1
+	bool audio_rate;
+
+	bool isActive() const {
+		return source != VSTFX_MOD_SRC_NONE && dest != VSTFX_MOD_DST_NONE &&
+			   amount != 0.0f;
+	}
+};
+
+/*!
+ * \brief The active routings of one tier, packed into contiguous arrays.
+ */
+struct VSTFX_ModRoutes {
+	int32_t count{0};
+	uint8_t source[VSTFX_MOD_SLOTS];
+	uint8_t dest[VSTFX_MOD_SLOTS];
+	float amount[VSTFX_MOD_SLOTS];
+
+	// adds every routing to `dests`, both indexed by their enums
+	void apply(const float *sources, float *dests) const {
+		for (int32_t i = 0; i < count; i++)
+			dests[dest[i]] += amount[i] * sources[source[i]];
+	}
+};
+
+/*!
+ * \brief Sources to destinations, in two tiers.
+ *
+ * Block rate routings are evaluated every VSTFX_MOD_BLOCK samples and
+ * ramped, audio rate ones every sample. Inactive slots are compiled out,
+ * so the cost follows the number of active routings, not of slots.
+ *
+ * The editor owns the slots and sends edits through a ring, the audio
+ * thread recompiles its tables when it picks them up in update().
+ */
+class VSTFX_ModMatrix {
+public:
+	VSTFX_ModMatrix();
+
+	// -------- Editor thread --------
+
+	/*!
+	 * \brief Changes a slot, returns false if too many edits are waiting.
+	 */
+	bool setSlot(int32_t index, const VSTFX_ModSlot &slot);
+	const VSTFX_ModSlot &getSlot(int32_t index) const { return slots[index]; }
+
+	// -------- Audio thread --------
+
+	void update();
+
+	const VSTFX_ModRoutes &blockRoutes() const { return block_routes; }
+	const VSTFX_ModRoutes &audioRoutes() const { return audio_routes; }
+
+	// pitch needs an exp2 per sample only if it is modulated at audio rate
+	bool hasAudioPitch() const { return audio_pitch; }
+
+private:
+	struct Edit {
+		int32_t index;
+		VSTFX_ModSlot slot;
+	};
+
+	void compile();
+
+	// audio thread's
+	VSTFX_ModSlot live[VSTFX_MOD_SLOTS];
+	VSTFX_ModRoutes block_routes;
+	VSTFX_ModRoutes audio_routes;
+	bool audio_pitch{false};
+
+	// the editor's, a line away on both sides from what the audio thread
+	// writes; the ring keeps its own ends apart
+	char pad_editor[VSTFX_CACHE_LINE];
+	VSTFX_ModSlot slots[VSTFX_MOD_SLOTS];
+	VSTFX_SpscRing<Edit, 64> edits;
+	char pad_end[VSTFX_CACHE_LINE];
+};
+
+#endif
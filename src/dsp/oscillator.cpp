@@ -0,0 +1,38 @@
+#include "oscillator.hpp"
+
+#include <cmath>
+
+void VSTFX_UnisonOsc::start(float base_step, int32_t count, float detune,
+							float spread, uint32_t seed) {
+	if (count < 1) count = 1;
+	if (count > VSTFX_MAX_UNISON) count = VSTFX_MAX_UNISON;
+	batches = (count + 3) / 4;
+
+	// equal power pan law, scaled so the center is at unity
+	const float quarter_pi = 0.78539816f;
+	float norm = sqrtf(2.0f / count);
+
+	for (int32_t k = 0; k < batches * 4; k++) {
+		if (k >= count) {
+			// padding lanes run silently alongside
+			phase[k] = 0.0f;
+			step[k] = base_step;
+			gain_l[k] = gain_r[k] = 0.0f;
+			continue;
+		}
+
+		// evenly spread over -1..1
+		float offset = count > 1 ? -1.0f + 2.0f * k / (count - 1) : 0.0f;
+
+		float cents = offset * detune * VSTFX_UNISON_MAX_CENTS;
+		step[k] = base_step * exp2f(cents / 1200.0f);
+
+		// free running copies start anywhere, so the attack isn't phasey
+		seed = seed * 1664525u + 1013904223u;
+		phase[k] = count > 1 ? (seed >> 8) * (1.0f / 16777216.0f) : 0.0f;
+
+		float angle = (offset * spread + 1.0f) * quarter_pi;
+		gain_l[k] = cosf(angle) * norm;
+		gain_r[k] = sinf(angle) * norm;
+	}
+}
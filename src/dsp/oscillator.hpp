@@ -0,0 +1,105 @@
+#ifndef VSTFX_OSCILLATOR_H
+#define VSTFX_OSCILLATOR_H
+
+#include "../util/simd.hpp"
+#include <cstdint>
+
+#define VSTFX_MAX_UNISON 16
+
+// sub-oscillators sit within this many cents of the note at full detune
+#define VSTFX_UNISON_MAX_CENTS 50.0f
+
+enum VSTFX_Waveform {
+	VSTFX_WAVE_SINE = 0,
+	VSTFX_WAVE_SAW, // PolyBLEP band limited
+
+	VSTFX_WAVE_COUNT
+};
+
+/*!
+ * \brief The detuned copies of one note, advanced four at a time.
+ *
+ * Detune ratios, start phases and stereo gains are fixed at note on, so a
+ * sample costs one pass over VSTFX_Float4 batches and no transcendentals.
+ */
+struct VSTFX_UnisonOsc {
+	int32_t batches; // groups of four sub-oscillators in use
+
+	float phase[VSTFX_MAX_UNISON]; // cycles, 0..1
+	float step[VSTFX_MAX_UNISON];  // cycles per sample, detune included
+	float gain_l[VSTFX_MAX_UNISON];
+	float gain_r[VSTFX_MAX_UNISON];
+
+	/*!
+	 * \brief Sets up `count` copies of a note, `detune` and `spread`
+	 * 0..1. A single copy starts at phase 0 in the center.
+	 */
+	void start(float base_step, int32_t count, float detune, float spread,
+			   uint32_t seed);
+
+	/*!
+	 * \brief Moves every copy by `factor` in frequency, phases and
+	 * detune intact, for legato.
+	 */
+	void retune(float factor) {
+		for (int32_t k = 0; k < batches * 4; k++)
+			step[k] *= factor;
+	}
+
+	/*!
+	 * \brief Advances every copy by one sample, at `ratio` times the
+	 * note's pitch, and mixes them down to stereo.
+	 */
+	void next(VSTFX_Waveform wave, float ratio, float *left, float *right) {
+		VSTFX_Float4 r(ratio), one(1.0f);
+		VSTFX_Float4 acc_l(0.0f), acc_r(0.0f);
+
+		for (int32_t b = 0; b < batches * 4; b += 4) {
+			VSTFX_Float4 t = VSTFX_Float4::load(phase + b);
+			VSTFX_Float4 dt = VSTFX_Float4::load(step + b) * r;
+
+			VSTFX_Float4 w = wave == VSTFX_WAVE_SAW ? Saw(t, dt) : Sine(t);
+			acc_l += w * VSTFX_Float4::load(gain_l + b);
+			acc_r += w * VSTFX_Float4::load(gain_r + b);
+
+			t = t + dt;
+			t = t - And(GreaterEq(t, one), one);
+			t.store(phase + b);
+		}
+
+		*left = acc_l.sum();
+		*right = acc_r.sum();
+	}
+
+	// sin(2 pi t) for t in 0..1, to about 1e-6
+	static VSTFX_Float4 Sine(VSTFX_Float4 t) {
+		// sin(2 pi t) = -sin(2 pi u), folded into |u| <= 0.25
+		VSTFX_Float4 u = t - 0.5f;
+		VSTFX_Float4 a = Abs(u);
+		a = Min(a, VSTFX_Float4(0.5f) - a);
+
+		VSTFX_Float4 x = a * 6.2831853f, x2 = x * x;
+		VSTFX_Float4 s =
+			x * (1.0f +
+				 x2 * (-1.0f / 6.0f +
+					   x2 * (1.0f / 120.0f +
+							 x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+		return CopySign(s, VSTFX_Float4(0.0f) - u);
+	}
+
+	// naive saw minus a polynomial step residual around the wrap
+	static VSTFX_Float4 Saw(VSTFX_Float4 t, VSTFX_Float4 dt) {
+		VSTFX_Float4 one(1.0f), two(2.0f);
+		VSTFX_Float4 inv_dt = one / dt;
+
+		VSTFX_Float4 x1 = t * inv_dt;
+		VSTFX_Float4 after = x1 * (two - x1) - one;
+		VSTFX_Float4 x2 = (t - one) * inv_dt;
+		VSTFX_Float4 before = x2 * (x2 + two) + one;
+
+		return t + t - one - And(Less(t, dt), after) -
+			   And(GreaterEq(t, one - dt), before);
+	}
+};
+
+#endif
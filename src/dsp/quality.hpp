@@ -0,0 +1,15 @@
+#ifndef VSTFX_QUALITY_H
+#define VSTFX_QUALITY_H
+
+/*!
+ * \brief Which kernels run. Offline renders have CPU to spare, live
+ * sessions keep the lean ones.
+ */
+enum VSTFX_Quality {
+	VSTFX_QUALITY_REALTIME = 0,
+	VSTFX_QUALITY_OFFLINE, // oversampled oscillators, cubic delay reads
+
+	VSTFX_QUALITY_COUNT
+};
+
+#endif
@@ -0,0 +1,351 @@
+#include "sample_library.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+// -------- WAV files --------
+
+static uint32_t ReadU32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t ReadU16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+#define WAVE_FORMAT_PCM 1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAVE_FORMAT_EXTENSIBLE 0xfffe
+
+bool VSTFX_SampleFile::open(const char *path) {
+	if (!map.open(path)) return false;
+
+	const uint8_t *data = map.data();
+	size_t size = map.size();
+	if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+		return false;
+
+	uint32_t tag = 0, bits = 0, align = 0;
+	const uint8_t *body = NULL;
+	size_t body_size = 0;
+
+	// walk the chunks, only "fmt " and "data" matter
+	size_t pos = 12;
+	while (pos + 8 <= size) {
+		const uint8_t *chunk = data + pos + 8;
+		size_t len = ReadU32(data + pos + 4);
+		size_t avail = size - pos - 8;
+		if (len > avail) len = avail;
+
+		if (!memcmp(data + pos, "fmt ", 4) && len >= 16) {
+			tag = ReadU16(chunk);
+			channels = ReadU16(chunk + 2);
+			rate = (float)ReadU32(chunk + 4);
+			align = ReadU16(chunk + 12);
+			bits = ReadU16(chunk + 14);
+			// the sub-format GUID starts with the plain format tag
+			if (tag == WAVE_FORMAT_EXTENSIBLE && len >= 26)
+				tag = ReadU16(chunk + 24);
+		} else if (!memcmp(data + pos, "data", 4)) {
+			body = chunk;
+			body_size = len;
+		}
+		pos += 8 + len + (len & 1);
+	}
+
+	if (tag == WAVE_FORMAT_PCM && bits == 16) {
+		format = VSTFX_SAMPLE_PCM16;
+	} else if (tag == WAVE_FORMAT_PCM && bits == 24) {
+		format = VSTFX_SAMPLE_PCM24;
+	} else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+		format = VSTFX_SAMPLE_FLOAT32;
+	} else {
+		return false;
+	}
+
+	if (!body || channels < 1 || rate <= 0.0f) return false;
+	if (align != (uint32_t)channels * bits / 8) return false;
+
+	pcm = body;
+	frame_bytes = (int32_t)align;
+	frames = (int32_t)(body_size / align);
+	if (frames < 2) return false;
+
+	// the only part of the file read at load
+	int32_t n = frames < VSTFX_SAMPLE_HEAD_FRAMES ? frames
+												  : VSTFX_SAMPLE_HEAD_FRAMES;
+	head.resize(n * 2);
+	decode(0, n, head.data());
+	return true;
+}
+
+void VSTFX_SampleFile::decode(int32_t first, int32_t count,
+							  float *out) const {
+	const uint8_t *p = pcm + (size_t)first * frame_bytes;
+	int32_t right = channels > 1 ? 1 : 0;
+
+	switch (format) {
+		case VSTFX_SAMPLE_PCM16:
+			for (int32_t i = 0; i < count; i++, p += frame_bytes) {
+				out[2 * i] = (int16_t)ReadU16(p) * (1.0f / 32768.0f);
+				out[2 * i + 1] =
+					(int16_t)ReadU16(p + 2 * right) * (1.0f / 32768.0f);
+			}
+			break;
+		case VSTFX_SAMPLE_PCM24:
+			for (int32_t i = 0; i < count; i++, p += frame_bytes) {
+				for (int32_t c = 0; c < 2; c++) {
+					const uint8_t *s = p + 3 * right * c;
+					int32_t v = (int32_t)((s[0] << 8) | (s[1] << 16) |
+										  ((uint32_t)s[2] << 24)) >>
+								8;
+					out[2 * i + c] = v * (1.0f / 8388608.0f);
+				}
+			}
+			break;
+		case VSTFX_SAMPLE_FLOAT32:
+			for (int32_t i = 0; i < count; i++, p += frame_bytes) {
+				memcpy(&out[2 * i], p, 4);
+				memcpy(&out[2 * i + 1], p + 4 * right, 4);
+			}
+			break;
+	}
+}
+
+// -------- Map parsing --------
+
+enum ZoneOpcode {
+	OP_LOKEY = 0,
+	OP_HIKEY,
+	OP_ROOT,
+	OP_LOVEL,
+	OP_HIVEL,
+
+	OP_COUNT
+};
+
+// region opcodes, unset ones are -1
+struct ZoneOps {
+	std::string sample;
+	int32_t op[OP_COUNT];
+
+	void clear() {
+		sample.clear();
+		for (int32_t &o : op)
+			o = -1;
+	}
+};
+
+// a MIDI key as a number or a note name, c4 being 60
+static int32_t ParseKey(const std::string &text) {
+	if (text.empty()) return -1;
+	if (isdigit((unsigned char)text[0]) || text[0] == '-')
+		return atoi(text.c_str());
+
+	static const int32_t steps[7] = {9, 11, 0, 2, 4, 5, 7}; // a..g
+	char letter = (char)tolower((unsigned char)text[0]);
+	if (letter < 'a' || letter > 'g') return -1;
+
+	int32_t key = steps[letter - 'a'];
+	size_t i = 1;
+	if (i < text.size() && text[i] == '#') key++, i++;
+	else if (i < text.size() && text[i] == 'b') key--, i++;
+	return key + (atoi(text.c_str() + i) + 1) * 12;
+}
+
+static void SetOpcode(ZoneOps &ops, const std::string &name,
+					  const std::string &value) {
+	if (name == "sample") {
+		ops.sample = value;
+	} else if (name == "key") {
+		int32_t k = ParseKey(value);
+		ops.op[OP_LOKEY] = ops.op[OP_HIKEY] = ops.op[OP_ROOT] = k;
+	} else if (name == "lokey") {
+		ops.op[OP_LOKEY] = ParseKey(value);
+	} else if (name == "hikey") {
+		ops.op[OP_HIKEY] = ParseKey(value);
+	} else if (name == "pitch_keycenter") {
+		ops.op[OP_ROOT] = ParseKey(value);
+	} else if (name == "lovel") {
+		ops.op[OP_LOVEL] = atoi(value.c_str());
+	} else if (name == "hivel") {
+		ops.op[OP_HIVEL] = atoi(value.c_str());
+	}
+}
+
+static int32_t OpOr(const ZoneOps &ops, int32_t op, int32_t fallback) {
+	return ops.op[op] >= 0 ? ops.op[op] : fallback;
+}
+
+// -------- Library --------
+
+bool VSTFX_SampleLibrary::load(const char *path) {
+	FILE *f = fopen(path, "rb");
+	if (!f) {
+		error = "cannot open the map file";
+		return false;
+	}
+	std::string text;
+	char buf[4096];
+	size_t got;
+	while ((got = fread(buf, 1, sizeof(buf), f)) > 0)
+		text.append(buf, got);
+	fclose(f);
+
+	// sample paths are relative to the map
+	std::string dir(path);
+	size_t slash = dir.find_last_of("/\\");
+	dir = slash == std::string::npos ? std::string() : dir.substr(0, slash + 1);
+
+	std::map<std::string, const VSTFX_SampleFile *> opened;
+	ZoneOps group, region;
+	group.clear();
+	bool in_region = false;
+	ZoneOps *target = NULL; // NULL inside headers we ignore
+
+	// adds the region being parsed, if any
+	auto flush = [&]() -> bool {
+		if (!in_region) return true;
+		in_region = false;
+		if (region.sample.empty()) return true;
+
+		std::string file = region.sample;
+		for (char &c : file)
+			if (c == '\\') c = '/';
+		if (file[0] != '/' && !(file.size() > 1 && file[1] == ':'))
+			file = dir + file;
+
+		const VSTFX_SampleFile *sample = opened[file];
+		if (!sample) {
+			std::unique_ptr<VSTFX_SampleFile> s(new VSTFX_SampleFile);
+			if (!s->open(file.c_str())) {
+				error = "cannot read a sample, it must be a 16/24 bit or "
+						"float WAV file";
+				return false;
+			}
+			sample = opened[file] = s.get();
+			files.push_back(std::move(s));
+		}
+
+		VSTFX_SampleZone z;
+		z.lo_key = OpOr(region, OP_LOKEY, 0);
+		z.hi_key = OpOr(region, OP_HIKEY, 127);
+		z.lo_vel = OpOr(region, OP_LOVEL, 1);
+		z.hi_vel = OpOr(region, OP_HIVEL, 127);
+		z.root = OpOr(region, OP_ROOT, 60);
+		z.file = sample;
+		zones.push_back(z);
+		return true;
+	};
+
+	size_t i = 0, n = text.size();
+	while (i < n) {
+		char c = text[i];
+		if (isspace((unsigned char)c)) {
+			i++;
+		} else if (c == '/' && i + 1 < n && text[i + 1] == '/') {
+			while (i < n && text[i] != '\n')
+				i++;
+		} else if (c == '<') {
+			size_t end = text.find('>', i);
+			if (end == std::string::npos) break;
+			std::string header = text.substr(i + 1, end - i - 1);
+			i = end + 1;
+
+			if (!flush()) return false;
+			if (header == "region") {
+				region = group;
+				in_region = true;
+				target = &region;
+			} else if (header == "group") {
+				group.clear();
+				target = &group;
+			} else {
+				target = NULL;
+			}
+		} else {
+			size_t eq = text.find('=', i);
+			if (eq == std::string::npos) break;
+			std::string name = text.substr(i, eq - i);
+			i = eq + 1;
+
+			// values end at whitespace, except sample paths, which run up
+			// to the next opcode, header or line end
+			size_t end = i;
+			if (name == "sample") {
+				while (end < n && text[end] != '\n' && text[end] != '\r' &&
+					   text[end] != '<') {
+					if (isspace((unsigned char)text[end])) {
+						size_t k = end;
+						while (k < n && (text[k] == ' ' || text[k] == '\t'))
+							k++;
+						size_t w = k;
+						while (w < n && (isalnum((unsigned char)text[w]) ||
+										 text[w] == '_'))
+							w++;
+						if (w > k && w < n && text[w] == '=') break;
+					}
+					end++;
+				}
+			} else {
+				while (end < n && !isspace((unsigned char)text[end]))
+					end++;
+			}
+
+			std::string value = text.substr(i, end - i);
+			while (!value.empty() && isspace((unsigned char)value.back()))
+				value.pop_back();
+			i = end;
+
+			if (target) SetOpcode(*target, name, value);
+		}
+	}
+	if (!flush()) return false;
+
+	if (zones.empty()) {
+		error = "the map has no regions";
+		return false;
+	}
+
+	buildKeyIndex();
+	return true;
+}
+
+void VSTFX_SampleLibrary::buildKeyIndex() {
+	key_zones.clear();
+	for (int32_t key = 0; key < 128; key++) {
+		key_first[key] = (int32_t)key_zones.size();
+		for (int32_t z = 0; z < (int32_t)zones.size(); z++) {
+			if (key >= zones[z].lo_key && key <= zones[z].hi_key)
+				key_zones.push_back(z);
+		}
+		key_count[key] = (int32_t)key_zones.size() - key_first[key];
+	}
+}
+
+int32_t VSTFX_SampleLibrary::find(int32_t key, int32_t velocity) const {
+	if (key < 0 || key > 127) return -1;
+
+	const int32_t *z = key_zones.data() + key_first[key];
+	for (int32_t i = 0; i < key_count[key]; i++) {
+		const VSTFX_SampleZone &zone = zones[z[i]];
+		if (velocity >= zone.lo_vel && velocity <= zone.hi_vel) return z[i];
+	}
+	return -1;
+}
+
+size_t VSTFX_SampleLibrary::getResidentBytes() const {
+	size_t bytes = 0;
+	for (const auto &f : files)
+		bytes += f->head.size() * sizeof(float);
+	return bytes;
+}
+
+size_t VSTFX_SampleLibrary::getMappedBytes() const {
+	size_t bytes = 0;
+	for (const auto &f : files)
+		bytes += f->map.size();
+	return bytes;
+}
@@ -0,0 +1,103 @@
+#ifndef VSTFX_SAMPLE_LIBRARY_H
+#define VSTFX_SAMPLE_LIBRARY_H
+
+#include "../util/mapped_file.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// frames of every sample decoded into RAM at load, 16 KB of stereo floats;
+// they cover the disk thread's latency when a note starts
+#define VSTFX_SAMPLE_HEAD_FRAMES 2048
+
+enum VSTFX_SampleFormat {
+	VSTFX_SAMPLE_PCM16 = 0,
+	VSTFX_SAMPLE_PCM24,
+	VSTFX_SAMPLE_FLOAT32
+};
+
+/*!
+ * \brief A mapped WAV file, plus its first frames decoded to stereo.
+ *
+ * Mono files are played on both channels, channels past the second are
+ * ignored.
+ */
+struct VSTFX_SampleFile {
+	VSTFX_MappedFile map;
+	const uint8_t *pcm{NULL}; // first frame, inside the mapping
+	VSTFX_SampleFormat format{VSTFX_SAMPLE_PCM16};
+	int32_t channels{0};
+	int32_t frame_bytes{0};
+	int32_t frames{0};
+	float rate{44100.0f};
+
+	std::vector<float> head; // interleaved stereo, up to the head frames
+
+	bool open(const char *path);
+
+	/*!
+	 * \brief Decodes `count` frames from `first` on into interleaved
+	 * stereo floats. Touches the mapping, so it may wait for the disk.
+	 */
+	void decode(int32_t first, int32_t count, float *out) const;
+};
+
+struct VSTFX_SampleZone {
+	int32_t lo_key, hi_key;
+	int32_t lo_vel, hi_vel;
+	int32_t root; // the key that plays the file at its own pitch
+	const VSTFX_SampleFile *file;
+};
+
+/*!
+ * \brief Zones and their sample files, read from an SFZ style map.
+ *
+ * Understands <group> and <region> headers with the sample, key, lokey,
+ * hikey, pitch_keycenter, lovel and hivel opcodes. Sample paths are
+ * relative to the map, and must point to WAV files: 16 or 24 bit PCM or
+ * 32 bit float, so compressed sources have to be decoded into a WAV cache
+ * first.
+ *
+ * Loading maps every file and decodes only its head, so the resident
+ * size is VSTFX_SAMPLE_HEAD_FRAMES per file, however long the samples are.
+ * A loaded library is never modified.
+ */
+class VSTFX_SampleLibrary {
+public:
+	bool load(const char *path);
+
+	// why load() failed, for the editor
+	const char *getError() const { return error; }
+
+	/*!
+	 * \brief The zone for a key and velocity, -1 if there is none. The
+	 * earliest matching region wins.
+	 */
+	int32_t find(int32_t key, int32_t velocity) const;
+
+	int32_t getZoneCount() const { return (int32_t)zones.size(); }
+	const VSTFX_SampleZone &getZone(int32_t index) const {
+		return zones[index];
+	}
+
+	int32_t getFileCount() const { return (int32_t)files.size(); }
+
+	// decoded heads, in bytes
+	size_t getResidentBytes() const;
+	// every mapped file, in bytes
+	size_t getMappedBytes() const;
+
+private:
+	void buildKeyIndex();
+
+	std::vector<std::unique_ptr<VSTFX_SampleFile>> files;
+	std::vector<VSTFX_SampleZone> zones;
+
+	// zones by key, in region order
+	std::vector<int32_t> key_zones;
+	int32_t key_first[128]{}, key_count[128]{};
+
+	const char *error{""};
+};
+
+#endif
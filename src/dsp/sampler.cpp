@@ -0,0 +1,290 @@
+#include "sampler.hpp"
+
+#include "../util/bits.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// fade out after note off
+#define SAMPLER_RELEASE_MS 30.0f
+
+VSTFX_Sampler::VSTFX_Sampler() { setSampleRate(sample_rate); }
+
+VSTFX_Sampler::~VSTFX_Sampler() {
+	if (disk_thread.joinable()) {
+		running.store(false);
+		wake.post();
+		disk_thread.join();
+	}
+	delete staged.load();
+	delete retired.load();
+	delete current;
+}
+
+// -------- Editor side --------
+
+bool VSTFX_Sampler::load(const char *path) {
+	auto t0 = std::chrono::steady_clock::now();
+
+	VSTFX_SampleLibrary *lib = new VSTFX_SampleLibrary;
+	if (!lib->load(path)) {
+		error = lib->getError();
+		delete lib;
+		return false;
+	}
+
+	error = "";
+	zone_count = lib->getZoneCount();
+	// the rings come with the first library, whatever its size
+	resident_bytes = lib->getResidentBytes() +
+					 VSTFX_SAMPLER_VOICES * sizeof(VSTFX_StreamSlot);
+	mapped_bytes = lib->getMappedBytes();
+	load_ms = std::chrono::duration<double, std::milli>(
+				  std::chrono::steady_clock::now() - t0)
+				  .count();
+
+	// an instance that never loads a library never pays for streaming,
+	// the audio thread only looks at these once it has one
+	if (!disk_thread.joinable()) {
+		slots.reset(new VSTFX_StreamSlot[VSTFX_SAMPLER_VOICES]);
+		voices.reset(new VSTFX_SamplerVoice[VSTFX_SAMPLER_VOICES]);
+		disk.reset(new DiskState[VSTFX_SAMPLER_VOICES]);
+		disk_block.reset(new VSTFX_StreamBlock);
+
+		running.store(true);
+		disk_thread = std::thread(&VSTFX_Sampler::diskLoop, this);
+	}
+
+	// one the audio thread has not picked up yet was never used
+	delete staged.exchange(lib, std::memory_order_acq_rel);
+	return true;
+}
+
+// -------- Disk thread --------
+
+void VSTFX_Sampler::diskLoop() {
+	VSTFX_StreamBlock &block = *disk_block;
+
+	while (running.load(std::memory_order_relaxed)) {
+		// the audio thread has let go of this one, and after this nothing
+		// below can still point into it
+		VSTFX_SampleLibrary *old = retired.load(std::memory_order_acquire);
+		if (old) {
+			for (int32_t i = 0; i < VSTFX_SAMPLER_VOICES; i++) {
+				if (disk[i].library == old) disk[i] = DiskState();
+			}
+			delete old;
+			retired.store(NULL, std::memory_order_release);
+		}
+
+		// one block per slot and pass, so a new note does not wait for
+		// the other rings to fill up
+		bool busy = true, streamed = false;
+		while (busy && running.load(std::memory_order_relaxed)) {
+			busy = false;
+			for (int32_t i = 0; i < VSTFX_SAMPLER_VOICES; i++) {
+				VSTFX_StreamSlot &slot = slots[i];
+				DiskState &st = disk[i];
+
+				uint64_t request = slot.request.load(std::memory_order_acquire);
+				if (request != st.request) {
+					// published before the request, so it is the library
+					// the zone index refers to
+					const VSTFX_SampleLibrary *lib =
+						library.load(std::memory_order_acquire);
+					uint32_t zone = (uint32_t)request;
+
+					st = DiskState();
+					st.request = request;
+					if (lib && zone && (int32_t)zone <= lib->getZoneCount()) {
+						st.library = lib;
+						st.file = lib->getZone(zone - 1).file;
+						st.position = (int32_t)st.file->head.size() / 2;
+					}
+				}
+
+				if (!st.file || st.position >= st.file->frames) continue;
+				if (slot.ring.size() >= slot.ring.capacity()) continue;
+
+				int32_t n = st.file->frames - st.position;
+				if (n > VSTFX_STREAM_BLOCK_FRAMES)
+					n = VSTFX_STREAM_BLOCK_FRAMES;
+
+				block.generation = (uint32_t)(request >> 32);
+				block.frames = n;
+				st.file->decode(st.position, n, block.data);
+				slot.ring.push(block);
+
+				st.position += n;
+				busy = streamed = true;
+			}
+		}
+
+		// nothing to read until the audio thread says so
+		if (!streamed) wake.wait();
+	}
+}
+
+// -------- Audio thread --------
+
+void VSTFX_Sampler::setSampleRate(float sr) {
+	sample_rate = sr;
+	release_step = 1000.0f / (SAMPLER_RELEASE_MS * sr);
+}
+
+void VSTFX_Sampler::update() {
+	// the disk thread still has to free the previous one
+	if (retired.load(std::memory_order_acquire)) return;
+
+	VSTFX_SampleLibrary *next =
+		staged.exchange(NULL, std::memory_order_acq_rel);
+	if (!next) return;
+
+	VSTFX_SampleLibrary *old = current;
+	current = next;
+	library.store(next, std::memory_order_release);
+
+	for (int32_t i = 0; i < VSTFX_SAMPLER_VOICES; i++) {
+		if (voices[i].active) startStream(i, 0);
+		voices[i].active = false;
+		alloc.free(i);
+	}
+	active_voices.store(0, std::memory_order_relaxed);
+
+	if (old) {
+		retired.store(old, std::memory_order_release);
+		wake.post();
+	}
+}
+
+void VSTFX_Sampler::startStream(int32_t index, uint32_t zone_plus_one) {
+	VSTFX_SamplerVoice &v = voices[index];
+	v.generation++;
+	// leftovers would hold up the disk thread until they were popped
+	slots[index].ring.discard();
+	slots[index].request.store(((uint64_t)v.generation << 32) | zone_plus_one,
+							   std::memory_order_release);
+	wake.post();
+}
+
+void VSTFX_Sampler::noteOn(int32_t note, int32_t velocity) {
+	if (!current) return;
+	int32_t zone = current->find(note, velocity);
+	if (zone < 0) return;
+
+	int32_t index = alloc.allocate(note, velocity);
+	const VSTFX_SampleZone &z = current->getZone(zone);
+	VSTFX_SamplerVoice &v = voices[index];
+	startStream(index, (uint32_t)zone + 1);
+
+	v.active = true;
+	v.released = false;
+	v.note = note;
+	v.gain = velocity / 127.0f;
+	v.fade = 1.0f;
+
+	v.file = z.file;
+	v.step = powf(2.0f, (note - z.root) / 12.0f) * z.file->rate / sample_rate;
+	v.frac = 0.0f;
+	v.source = 0;
+	v.block.frames = 0;
+	v.block_pos = 0;
+
+	// the head always has at least two frames
+	bool starved;
+	fetch(v, v.prev, &starved);
+	fetch(v, v.cur, &starved);
+}
+
+void VSTFX_Sampler::noteOff(int32_t note) {
+	for (uint32_t held = alloc.getHeld(note); held; held &= held - 1) {
+		int32_t i = VSTFX_LowestBit(held);
+		voices[i].released = true;
+		alloc.release(i);
+	}
+}
+
+// the next source frame, false past the end of the sample
+bool VSTFX_Sampler::fetch(VSTFX_SamplerVoice &v, float *frame,
+						  bool *starved) {
+	const VSTFX_SampleFile *f = v.file;
+	if (v.source >= f->frames) return false;
+
+	int32_t head = (int32_t)f->head.size() / 2;
+	if (v.source < head) {
+		frame[0] = f->head[2 * v.source];
+		frame[1] = f->head[2 * v.source + 1];
+		v.source++;
+		return true;
+	}
+
+	if (v.block_pos >= v.block.frames) {
+		VSTFX_StreamSlot &slot = slots[&v - voices.get()];
+		bool got = false;
+		while (!got && slot.ring.pop(v.block)) {
+			got = v.block.generation == v.generation;
+		}
+		wake.post(); // room in the ring, or a ring run dry
+		if (!got) {
+			// hold the position and play silence until the disk catches up
+			v.block.frames = 0;
+			*starved = true;
+			frame[0] = frame[1] = 0.0f;
+			return true;
+		}
+		v.block_pos = 0;
+	}
+
+	frame[0] = v.block.data[2 * v.block_pos];
+	frame[1] = v.block.data[2 * v.block_pos + 1];
+	v.block_pos++;
+	v.source++;
+	return true;
+}
+
+void VSTFX_Sampler::render(float *left, float *right, int32_t frames) {
+	int32_t active = 0;
+
+	for (uint32_t mask = alloc.getActive(); mask; mask &= mask - 1) {
+		int32_t index = VSTFX_LowestBit(mask);
+		VSTFX_SamplerVoice &v = voices[index];
+
+		bool starved = false;
+		for (int32_t i = 0; i < frames; i++) {
+			float amp = v.gain * v.fade;
+			left[i] += amp * (v.prev[0] + (v.cur[0] - v.prev[0]) * v.frac);
+			right[i] += amp * (v.prev[1] + (v.cur[1] - v.prev[1]) * v.frac);
+
+			if (v.released) {
+				v.fade -= release_step;
+				if (v.fade <= 0.0f) {
+					v.active = false;
+					break;
+				}
+			}
+
+			v.frac += v.step;
+			while (v.frac >= 1.0f) {
+				v.frac -= 1.0f;
+				v.prev[0] = v.cur[0];
+				v.prev[1] = v.cur[1];
+				if (!fetch(v, v.cur, &starved)) {
+					v.active = false;
+					break;
+				}
+			}
+			if (!v.active) break;
+		}
+
+		if (starved) underruns.fetch_add(1, std::memory_order_relaxed);
+		if (v.active) {
+			alloc.setLevel(index, v.gain * v.fade);
+			active++;
+		} else {
+			startStream(index, 0); // the disk thread can stop
+			alloc.free(index);
+		}
+	}
+
+	active_voices.store(active, std::memory_order_relaxed);
+}
@@ -0,0 +1,171 @@
+#ifndef VSTFX_SAMPLER_H
+#define VSTFX_SAMPLER_H
+
+#include "../util/spsc_ring.hpp"
+#include "../util/wake_event.hpp"
+#include "sample_library.hpp"
+#include "voice_alloc.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#define VSTFX_SAMPLER_VOICES 16
+static_assert(VSTFX_SAMPLER_VOICES <= VSTFX_ALLOC_MAX_VOICES,
+			  "too many voices");
+
+// what the disk thread streams into a voice's ring at a time
+#define VSTFX_STREAM_BLOCK_FRAMES 1024
+// blocks per ring, 64 KB of stereo floats per voice
+#define VSTFX_STREAM_BLOCKS 8
+
+struct VSTFX_StreamBlock {
+	uint32_t generation; // of the voice it was read for
+	int32_t frames;
+	float data[VSTFX_STREAM_BLOCK_FRAMES * 2]; // interleaved stereo
+};
+
+/*!
+ * \brief The disk thread's link to one voice.
+ *
+ * The audio thread publishes what to stream in `request`, the disk thread
+ * answers through `ring`. Blocks of an older generation are left over from
+ * a previous note and get dropped.
+ */
+struct VSTFX_StreamSlot {
+	// generation << 32 | zone index + 1, or 0 in the low half when idle
+	std::atomic<uint64_t> request{0};
+	VSTFX_SpscRing<VSTFX_StreamBlock, VSTFX_STREAM_BLOCKS> ring;
+};
+
+struct VSTFX_SamplerVoice {
+	bool active{false};
+	bool released{false};
+	int32_t note{0};
+	float gain{0.0f};
+	float fade{1.0f};
+
+	const VSTFX_SampleFile *file{NULL};
+	uint32_t generation{0};
+	float step{1.0f}; // source frames per output frame
+	float frac{0.0f};
+	int32_t source{0}; // next frame to fetch
+	float prev[2], cur[2];
+
+	// the block being played, once past the head
+	VSTFX_StreamBlock block;
+	int32_t block_pos{0};
+};
+
+/*!
+ * \brief Plays multisampled libraries straight from disk.
+ *
+ * A note starts on the head decoded at load and continues on blocks that
+ * a background thread reads from the mapped file ahead of it. The audio
+ * thread never touches the mapping, so it never waits for the disk; when
+ * a ring runs dry the voice pauses and an underrun is counted.
+ *
+ * Libraries are swapped on the audio thread and freed on the disk thread,
+ * so neither ever sees a library go away under it.
+ */
+class VSTFX_Sampler {
+public:
+	VSTFX_Sampler();
+	~VSTFX_Sampler();
+
+	// -------- Editor side --------
+
+	/*!
+	 * \brief Loads a library and hands it to the audio thread, which
+	 * starts using it on its next block. Allocates the streaming rings
+	 * and starts the disk thread the first time. On failure the current
+	 * library stays.
+	 */
+	bool load(const char *path);
+
+	// from the last load() call
+	const char *getError() const { return error; }
+	int32_t getZoneCount() const { return zone_count; }
+	size_t getResidentBytes() const { return resident_bytes; }
+	size_t getMappedBytes() const { return mapped_bytes; }
+	double getLoadMs() const { return load_ms; }
+
+	// readable from any thread
+	uint32_t getUnderruns() const {
+		return underruns.load(std::memory_order_relaxed);
+	}
+	int32_t getActiveVoices() const {
+		return active_voices.load(std::memory_order_relaxed);
+	}
+
+	// -------- Audio thread --------
+
+	void setSampleRate(float sr);
+
+	/*!
+	 * \brief Picks up a newly loaded library, stopping every voice.
+	 */
+	void update();
+
+	bool hasLibrary() const { return current != NULL; }
+
+	void setPolicy(VSTFX_StealPolicy policy) { alloc.setPolicy(policy); }
+
+	void noteOn(int32_t note, int32_t velocity);
+	void noteOff(int32_t note);
+
+	// adds every sounding voice to `left` and `right`
+	void render(float *left, float *right, int32_t frames);
+
+private:
+	// what the disk thread is streaming for a slot
+	struct DiskState {
+		uint64_t request{0};
+		const VSTFX_SampleLibrary *library{NULL};
+		const VSTFX_SampleFile *file{NULL};
+		int32_t position{0};
+	};
+
+	void diskLoop();
+
+	void startStream(int32_t index, uint32_t zone_plus_one);
+	bool fetch(VSTFX_SamplerVoice &v, float *frame, bool *starved);
+
+	std::unique_ptr<VSTFX_StreamSlot[]> slots;
+	std::unique_ptr<VSTFX_SamplerVoice[]> voices;
+	std::unique_ptr<DiskState[]> disk;
+	std::unique_ptr<VSTFX_StreamBlock> disk_block;
+
+	// handover: editor -> staged -> audio (current, library) -> retired
+	// -> disk thread, which deletes it
+	std::atomic<VSTFX_SampleLibrary *> staged{NULL};
+	std::atomic<VSTFX_SampleLibrary *> library{NULL};
+	std::atomic<VSTFX_SampleLibrary *> retired{NULL};
+	VSTFX_SampleLibrary *current{NULL};
+
+	// the disk thread sleeps on `wake` whenever every ring is full or
+	// idle, new requests, popped blocks and retired libraries post it
+	std::thread disk_thread;
+	std::atomic<bool> running{false};
+	VSTFX_WakeEvent wake;
+
+	// the disk thread reads the fields above, the audio thread writes the
+	// ones below every block, a line apart so the reads do not miss
+	char pad_disk[VSTFX_CACHE_LINE];
+
+	std::atomic<uint32_t> underruns{0};
+	std::atomic<int32_t> active_voices{0};
+
+	float sample_rate{44100.0f};
+	float release_step{1.0f};
+	VSTFX_VoiceAllocator alloc{VSTFX_SAMPLER_VOICES};
+	char pad_audio[VSTFX_CACHE_LINE];
+
+	// editor only
+	const char *error{""};
+	int32_t zone_count{0};
+	size_t resident_bytes{0}, mapped_bytes{0};
+	double load_ms{0.0};
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef VSTFX_SMOOTHER_H
+#define VSTFX_SMOOTHER_H
+
+#include <cstdint>
+
+/*!
+ * \brief Linear ramp towards a target value, so parameter changes from the
+ * host or from MIDI controllers don't click.
+ *
+ * A new target restarts the ramp from wherever the value currently is.
+ */
+class VSTFX_Smoother {
+public:
+	void reset(float value) {
+		current = target = value;
+		remaining = 0;
+	}
+
+	void setRampLength(int32_t samples) {
+		ramp_length = samples > 0 ? samples : 1;
+	}
+
+	void setTarget(float value) {
+		if (value == target) return;
+		target = value;
+		remaining = ramp_length;
+		step = (target - current) / ramp_length;
+	}
+
+	float next() {
+		if (remaining > 0) {
+			current = (--remaining == 0) ? target : current + step;
+		}
+		return current;
+	}
+
+	// skips `samples` steps at once, for values only read once per chunk
+	float advance(int32_t samples) {
+		if (remaining > 0) {
+			int32_t k = samples < remaining ? samples : remaining;
+			remaining -= k;
+			current = (remaining == 0) ? target : current + step * k;
+		}
+		return current;
+	}
+
+	float getTarget() const { return target; }
+
+private:
+	float current{0.0f}, target{0.0f}, step{0.0f};
+	int32_t remaining{0};
+	int32_t ramp_length{1};
+};
+
+#endif
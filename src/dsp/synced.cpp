@@ -0,0 +1,99 @@
+#include "synced.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#define TWO_PI 6.283185307179586
+
+// -------- LFO --------
+
+void VSTFX_SyncedLfo::begin(const VSTFX_Transport &transport,
+							int32_t division) {
+	double beats = divisionTable[division].beats;
+	double cycles = transport.beatAt(0) / beats;
+
+	phase = cycles - floor(cycles);
+	increment = transport.beatsPerSample() / beats;
+}
+
+float VSTFX_SyncedLfo::next() {
+	float value = sinf((float)(TWO_PI * phase));
+	phase += increment;
+	if (phase >= 1.0) phase -= 1.0;
+	return value;
+}
+
+// -------- Delay --------
+
+void VSTFX_SyncedDelay::setSampleRate(float sample_rate) {
+	// 50 ms glide between delay times
+	time.setRampLength((int32_t)(sample_rate * 0.05f));
+
+	int32_t want = (int32_t)(sample_rate * VSTFX_DELAY_MAX_SECONDS) + 2;
+	if (want == size) return;
+
+	// the old line, shorter in seconds at the new rate, beats none
+	VSTFX_ZeroPages next;
+	if (!next.allocate(want * sizeof(float))) return;
+	pages.swap(next);
+
+	line = (float *)pages.data();
+	size = want;
+	write = 0;
+	max_delay = (float)(size - 2);
+}
+
+void VSTFX_SyncedDelay::clear() {
+	if (line) memset(line, 0, size * sizeof(float));
+	write = 0;
+}
+
+void VSTFX_SyncedDelay::begin(const VSTFX_Transport &transport,
+							  int32_t division) {
+	float samples = (float)transport.divisionSamples(division);
+	if (samples > max_delay) samples = max_delay;
+	if (samples < 1.0f) samples = 1.0f;
+
+	// the first block starts at the right time instead of gliding there
+	if (time.getTarget() == 0.0f) time.reset(samples);
+	time.setTarget(samples);
+}
+
+template <VSTFX_Quality Q>
+float VSTFX_SyncedDelay::process(float in, float feedback, float mix) {
+	float delay = time.next();
+	if (!line) return in; // bypassed, no memory for a line
+	// the Hermite curve reads one sample past the pair, which must not be
+	// the one written below
+	if (Q == VSTFX_QUALITY_OFFLINE && delay < 2.0f) delay = 2.0f;
+
+	float read = write - delay;
+	if (read < 0.0f) read += size;
+	int32_t i0 = (int32_t)read;
+	int32_t i1 = (i0 + 1 == size) ? 0 : i0 + 1;
+	float frac = read - i0;
+
+	float delayed;
+	if (Q == VSTFX_QUALITY_OFFLINE) {
+		int32_t im = (i0 == 0) ? size - 1 : i0 - 1;
+		int32_t i2 = (i1 + 1 == size) ? 0 : i1 + 1;
+		float xm = line[im], x0 = line[i0], x1 = line[i1], x2 = line[i2];
+		float c1 = 0.5f * (x1 - xm);
+		float c2 = xm - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+		float c3 = 0.5f * (x2 - xm) + 1.5f * (x0 - x1);
+		delayed = ((c3 * frac + c2) * frac + c1) * frac + x0;
+	} else {
+		// linear between the two samples around the read point
+		delayed = line[i0] + (line[i1] - line[i0]) * frac;
+	}
+
+	line[write] = in + delayed * feedback;
+	if (++write == size) write = 0;
+
+	return in + delayed * mix;
+}
+
+template float VSTFX_SyncedDelay::process<VSTFX_QUALITY_REALTIME>(float, float,
+																  float);
+template float VSTFX_SyncedDelay::process<VSTFX_QUALITY_OFFLINE>(float, float,
+																 float);
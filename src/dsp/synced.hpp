@@ -0,0 +1,65 @@
+#ifndef VSTFX_SYNCED_H
+#define VSTFX_SYNCED_H
+
+#include "quality.hpp"
+#include "smoother.hpp"
+#include "transport.hpp"
+#include "../util/zero_pages.hpp"
+#include <cstdint>
+
+// longest delay line, whatever the tempo
+#define VSTFX_DELAY_MAX_SECONDS 4.0f
+
+/*!
+ * \brief Sine LFO locked to the host's beat position.
+ *
+ * begin() derives the phase from the transport once per block, next()
+ * then advances it per sample, so the LFO lands on the beat grid without
+ * evaluating the position for every sample.
+ */
+class VSTFX_SyncedLfo {
+public:
+	void begin(const VSTFX_Transport &transport, int32_t division);
+
+	// -1..1
+	float next();
+
+private:
+	double phase{0.0}, increment{0.0}; // in cycles
+};
+
+/*!
+ * \brief Feedback delay whose time follows a note division.
+ *
+ * The line is allocated in setSampleRate() and its pages are faulted in
+ * by clear() on resume, never on the audio thread. An instance a host
+ * only creates to scan is never resumed and costs next to nothing. Tempo
+ * and division changes glide instead of jumping.
+ */
+class VSTFX_SyncedDelay {
+public:
+	/*!
+	 * \brief Sizes the line for the rate. If the OS refuses the memory,
+	 * the previous line stays, or the delay is bypassed without one.
+	 */
+	void setSampleRate(float sample_rate);
+
+	// silences the line, touching every page of it
+	void clear();
+
+	void begin(const VSTFX_Transport &transport, int32_t division);
+
+	// returns dry plus `mix` times the delayed signal, read between samples
+	// linearly, or with a 4 point Hermite curve offline
+	template <VSTFX_Quality Q>
+	float process(float in, float feedback, float mix);
+
+private:
+	VSTFX_ZeroPages pages;
+	float *line{NULL};
+	int32_t size{0}, write{0};
+	float max_delay{1.0f};
+	VSTFX_Smoother time; // in samples
+};
+
+#endif
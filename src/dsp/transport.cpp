@@ -0,0 +1,32 @@
+#include "transport.hpp"
+
+const VSTFX_DivisionDesc divisionTable[VSTFX_DIVISION_COUNT] = {
+	{"1/32", 0.125f},	  {"1/16T", 1.0f / 6.0f}, {"1/16", 0.25f},
+	{"1/8T", 1.0f / 3.0f}, {"1/8", 0.5f},		  {"1/8.", 0.75f},
+	{"1/4", 1.0f},		  {"1/4.", 1.5f},		  {"1/2", 2.0f},
+	{"1/1", 4.0f},
+};
+
+void VSTFX_Transport::update(const Vst::VstTimeInfo *info,
+							 double sample_rate, int32_t frames) {
+	int32_t flags = info ? info->flags : 0;
+
+	if ((flags & Vst::kVstTempoValid) && info->tempo > 0.0) {
+		tempo = info->tempo;
+	}
+	playing = flags & Vst::kVstTransportPlaying;
+
+	// follow the host while it plays, run freely otherwise
+	if (playing && (flags & Vst::kVstPpqPosValid)) {
+		block_beat = info->ppqPos;
+	} else {
+		block_beat = next_beat;
+	}
+
+	beats_per_sample = tempo / (60.0 * sample_rate);
+	next_beat = block_beat + frames * beats_per_sample;
+}
+
+double VSTFX_Transport::divisionSamples(int32_t division) const {
+	return divisionTable[division].beats / beats_per_sample;
+}
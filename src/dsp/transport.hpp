@@ -0,0 +1,77 @@
+#ifndef VSTFX_TRANSPORT_H
+#define VSTFX_TRANSPORT_H
+
+#include "../vst.h"
+#include <cstdint>
+
+// note lengths for tempo synced parameters, shortest first
+enum VSTFX_Division {
+	VSTFX_DIV_1_32 = 0,
+	VSTFX_DIV_1_16T,
+	VSTFX_DIV_1_16,
+	VSTFX_DIV_1_8T,
+	VSTFX_DIV_1_8,
+	VSTFX_DIV_1_8D,
+	VSTFX_DIV_1_4,
+	VSTFX_DIV_1_4D,
+	VSTFX_DIV_1_2,
+	VSTFX_DIV_1_1,
+
+	VSTFX_DIVISION_COUNT
+};
+
+struct VSTFX_DivisionDesc {
+	const char *name;
+	float beats; // in quarter notes
+};
+
+extern const VSTFX_DivisionDesc divisionTable[VSTFX_DIVISION_COUNT];
+
+/*!
+ * \brief Host tempo and musical position, sampled once per block.
+ *
+ * VSTFX::processReplacing makes the only audioMasterGetTime call and hands
+ * the result to update(). Everything else reads positions from here, so
+ * no voice or sample can end up calling back into the host.
+ *
+ * Without a playing host transport, the position keeps running at the
+ * last known tempo so synced modulation doesn't freeze.
+ */
+class VSTFX_Transport {
+public:
+	// the only fields update() reads
+	static const int32_t kQueryFlags =
+		Vst::kVstPpqPosValid | Vst::kVstTempoValid;
+
+	/*!
+	 * \brief Takes over the host's time info for the block that is about
+	 * to be rendered. `info` may be NULL.
+	 */
+	void update(const Vst::VstTimeInfo *info, double sample_rate,
+				int32_t frames);
+
+	// -------- Sample accurate positions --------
+
+	// position in quarter notes, `offset` samples into the block
+	double beatAt(int32_t offset) const {
+		return block_beat + offset * beats_per_sample;
+	}
+
+	double beatsPerSample() const { return beats_per_sample; }
+	double getTempo() const { return tempo; }
+	bool isPlaying() const { return playing; }
+
+	/*!
+	 * \brief Length of a note division in samples at the current tempo.
+	 */
+	double divisionSamples(int32_t division) const;
+
+private:
+	double tempo{120.0};
+	double block_beat{0.0};
+	double next_beat{0.0};
+	double beats_per_sample{0.0};
+	bool playing{false};
+};
+
+#endif
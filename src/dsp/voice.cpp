@@ -0,0 +1,283 @@
+#include "voice.hpp"
+
+#include "../util/bits.hpp"
+#include <cmath>
+
+static_assert(VSTFX_FILTER_FRAME == 8,
+			  "the lane mixdown expects 4 lanes in 2 channels");
+
+// fade out after note off, instead of the click of a hard cut
+#define RELEASE_FADE_MS 5.0f
+
+VSTFX_VoiceEngine::VSTFX_VoiceEngine() { setSampleRate(sample_rate); }
+
+void VSTFX_VoiceEngine::setSampleRate(float sr) {
+	sample_rate = sr;
+	fade_step = 1000.0f / (RELEASE_FADE_MS * sr);
+	filter.setSampleRate(sr);
+}
+
+// -------- Notes --------
+
+void VSTFX_VoiceEngine::setUnison(int32_t count, float detune_amount,
+								  float spread_amount) {
+	unison = count;
+	detune = detune_amount;
+	spread = spread_amount;
+}
+
+void VSTFX_VoiceEngine::setMode(VSTFX_VoiceMode next_mode,
+								VSTFX_StealPolicy policy) {
+	alloc.setPolicy(policy);
+	if (next_mode == mode) return;
+
+	// the stack only tracks keys pressed in mono and legato, so notes
+	// held from before would never see their note off there
+	mode = next_mode;
+	keys = VSTFX_NoteStack();
+	if (mode == VSTFX_VOICE_POLY) return;
+
+	for (int32_t i = 0; i < VSTFX_MAX_VOICES; i++)
+		releaseVoice(i);
+}
+
+void VSTFX_VoiceEngine::noteOn(int32_t note, int32_t velocity) {
+	if (mode == VSTFX_VOICE_POLY) {
+		startVoice(alloc.allocate(note, velocity), note, velocity);
+		return;
+	}
+
+	// mono and legato play every note on the first voice
+	VSTFX_Voice &v = voices[0];
+	bool overlap = keys.top() >= 0 && v.active && !v.released;
+	keys.push(note, velocity);
+	alloc.assign(0, note, velocity);
+
+	if (mode == VSTFX_VOICE_LEGATO && overlap) {
+		v.osc.retune(powf(2.0f, (note - v.note) / 12.0f));
+		v.note = note;
+	} else {
+		startVoice(0, note, velocity);
+	}
+}
+
+void VSTFX_VoiceEngine::noteOff(int32_t note) {
+	if (mode == VSTFX_VOICE_POLY) {
+		for (uint32_t held = alloc.getHeld(note); held; held &= held - 1)
+			releaseVoice(VSTFX_LowestBit(held));
+		return;
+	}
+
+	bool sounding = keys.top() == note;
+	keys.remove(note);
+	if (!sounding) return;
+
+	// back to the most recent key still down, if any
+	int32_t back = keys.top();
+	if (back < 0) {
+		releaseVoice(0);
+		return;
+	}
+	noteOn(back, keys.velocityOf(back));
+}
+
+void VSTFX_VoiceEngine::startVoice(int32_t index, int32_t note,
+								   int32_t velocity) {
+	VSTFX_Voice *v = &voices[index];
+	v->active = true;
+	v->released = false;
+	v->note = note;
+	v->velocity = velocity / 127.0f;
+
+	// Note 69 is A (440Hz). 12 notes per octave.
+	float step = (440.0f / sample_rate) * powf(2.0f, (note - 69) / 12.0f);
+	v->osc.start(step, unison, detune, spread, note_counter++);
+	v->quality = quality;
+	v->decimator[0].reset();
+	v->decimator[1].reset();
+	v->env = VSTFX_VOICE_LEVEL;
+	v->fade = 1.0f;
+
+	for (float &m : v->mod)
+		m = 0.0f;
+	v->filter.reset();
+}
+
+void VSTFX_VoiceEngine::releaseVoice(int32_t index) {
+	if (!voices[index].active) return;
+	voices[index].released = true;
+	alloc.release(index);
+}
+
+int32_t VSTFX_VoiceEngine::getActiveVoices() const {
+	int32_t n = 0;
+	for (uint32_t active = alloc.getActive(); active; active &= active - 1)
+		n++;
+	return n;
+}
+
+// -------- Rendering --------
+
+void VSTFX_VoiceEngine::render(float *left, float *right, int32_t frames,
+							   const VSTFX_VoiceContext &ctx) {
+	matrix.update();
+
+	VSTFX_Voice *active[VSTFX_MAX_VOICES];
+	int32_t count = 0;
+	for (uint32_t mask = alloc.getActive(); mask; mask &= mask - 1)
+		active[count++] = &voices[VSTFX_LowestBit(mask)];
+	if (!count) return;
+
+	// unused lanes filter silence into a scratch state
+	VSTFX_FilterState spare;
+	spare.reset();
+
+	for (int32_t start = 0; start < frames; start += VSTFX_VOICE_CHUNK) {
+		int32_t n = frames - start;
+		if (n > VSTFX_VOICE_CHUNK) n = VSTFX_VOICE_CHUNK;
+
+		VSTFX_VoiceContext chunk = ctx;
+		chunk.lfo = ctx.lfo + start;
+
+		for (int32_t first = 0; first < count;
+			 first += VSTFX_FILTER_LANES) {
+			float lanes[VSTFX_VOICE_CHUNK * VSTFX_FILTER_FRAME] = {0.0f};
+			float cutoff_mod[VSTFX_VOICE_SUBBLOCKS * VSTFX_FILTER_LANES];
+			VSTFX_FilterState *states[VSTFX_FILTER_LANES];
+
+			for (int32_t lane = 0; lane < VSTFX_FILTER_LANES; lane++) {
+				VSTFX_Voice *v =
+					first + lane < count ? active[first + lane] : NULL;
+				states[lane] = v ? &v->filter : &spare;
+
+				float mod[VSTFX_VOICE_SUBBLOCKS] = {0.0f};
+				if (v && v->active && v->quality == VSTFX_QUALITY_OFFLINE) {
+					renderVoice<VSTFX_QUALITY_OFFLINE>(
+						*v, lanes + lane, VSTFX_FILTER_FRAME, n, chunk, mod);
+				} else if (v && v->active) {
+					renderVoice<VSTFX_QUALITY_REALTIME>(
+						*v, lanes + lane, VSTFX_FILTER_FRAME, n, chunk, mod);
+				}
+				for (int32_t sb = 0; sb < VSTFX_VOICE_SUBBLOCKS; sb++) {
+					cutoff_mod[sb * VSTFX_FILTER_LANES + lane] =
+						ctx.cutoff + mod[sb] * VSTFX_FILTER_MOD_OCTAVES;
+				}
+			}
+
+			if (ctx.filter != VSTFX_FILTER_OFF) {
+				filter.process(ctx.filter, states, lanes, n, VSTFX_MOD_BLOCK,
+							   cutoff_mod, ctx.resonance);
+			}
+
+			const float *p = lanes;
+			for (int32_t i = 0; i < n; i++, p += VSTFX_FILTER_FRAME) {
+				left[start + i] += (p[0] + p[1]) + (p[2] + p[3]);
+				right[start + i] += (p[4] + p[5]) + (p[6] + p[7]);
+			}
+		}
+	}
+
+	// finished voices free up, the rest report their level for stealing
+	for (int32_t i = 0; i < count; i++) {
+		VSTFX_Voice &v = *active[i];
+		int32_t index = (int32_t)(&v - voices);
+		if (!v.active) {
+			alloc.free(index);
+		} else {
+			alloc.setLevel(index, v.env * (1.0f / VSTFX_VOICE_LEVEL) *
+									  v.fade * v.velocity);
+		}
+	}
+}
+
+template <VSTFX_Quality Q>
+void VSTFX_VoiceEngine::renderVoice(VSTFX_Voice &v, float *out,
+									int32_t stride, int32_t frames,
+									const VSTFX_VoiceContext &ctx,
+									float *cutoff_mod) {
+	const VSTFX_ModRoutes &block = matrix.blockRoutes();
+	const VSTFX_ModRoutes &audio = matrix.audioRoutes();
+	bool audio_pitch = matrix.hasAudioPitch();
+	float decay = ctx.release / sample_rate;
+
+	float src[VSTFX_MOD_SRC_COUNT];
+	src[VSTFX_MOD_SRC_NONE] = 0.0f;
+	src[VSTFX_MOD_SRC_VELOCITY] = v.velocity;
+	src[VSTFX_MOD_SRC_MODWHEEL] = ctx.modwheel;
+
+	for (int32_t start = 0, sb = 0; start < frames;
+		 start += VSTFX_MOD_BLOCK, sb++) {
+		int32_t n = frames - start;
+		if (n > VSTFX_MOD_BLOCK) n = VSTFX_MOD_BLOCK;
+
+		// block rate: evaluate for the end of the sub-block, ramp there
+		src[VSTFX_MOD_SRC_ENV] = v.env * (1.0f / VSTFX_VOICE_LEVEL);
+		src[VSTFX_MOD_SRC_LFO] = ctx.lfo[start + n - 1];
+
+		float target[VSTFX_MOD_DST_COUNT] = {0.0f};
+		block.apply(src, target);
+
+		float cur[VSTFX_MOD_DST_COUNT], step[VSTFX_MOD_DST_COUNT];
+		for (int32_t d = 0; d < VSTFX_MOD_DST_COUNT; d++) {
+			cur[d] = v.mod[d];
+			step[d] = (target[d] - v.mod[d]) / n;
+			v.mod[d] = target[d];
+		}
+
+		// block rate pitch ramps as a frequency ratio, no exp2 per sample
+		float ratio = exp2f(cur[VSTFX_MOD_DST_PITCH]);
+		float ratio_step = (exp2f(target[VSTFX_MOD_DST_PITCH]) - ratio) / n;
+
+		for (int32_t i = 0; i < n; i++) {
+			float dst[VSTFX_MOD_DST_COUNT];
+			for (int32_t d = 0; d < VSTFX_MOD_DST_COUNT; d++) {
+				dst[d] = cur[d];
+				cur[d] += step[d];
+			}
+
+			// audio rate: per sample, on top of the block rate ramps
+			float r = ratio;
+			if (audio.count) {
+				src[VSTFX_MOD_SRC_ENV] = v.env * (1.0f / VSTFX_VOICE_LEVEL);
+				src[VSTFX_MOD_SRC_LFO] = ctx.lfo[start + i];
+				audio.apply(src, dst);
+				if (audio_pitch) r = exp2f(dst[VSTFX_MOD_DST_PITCH]);
+			}
+			ratio += ratio_step;
+
+			float gain = 1.0f + dst[VSTFX_MOD_DST_GAIN];
+			if (gain < 0.0f) gain = 0.0f;
+			float rate = 1.0f + dst[VSTFX_MOD_DST_RELEASE];
+			if (rate < 0.0f) rate = 0.0f;
+
+			float l, rr;
+			if (Q == VSTFX_QUALITY_OFFLINE) {
+				// two half steps, so the saw's step residual is half as
+				// wide and its aliases fall where the decimator removes them
+				float l0, r0, l1, r1;
+				v.osc.next(ctx.wave, 0.5f * r, &l0, &r0);
+				v.osc.next(ctx.wave, 0.5f * r, &l1, &r1);
+				l = v.decimator[0].process(l0, l1);
+				rr = v.decimator[1].process(r0, r1);
+			} else {
+				v.osc.next(ctx.wave, r, &l, &rr);
+			}
+
+			float amp = v.envelope(decay * rate, fade_step) * gain;
+			out[(start + i) * stride] += amp * l;
+			out[(start + i) * stride + VSTFX_FILTER_LANES] += amp * rr;
+		}
+
+		// the filter follows audio rate cutoff routings per sub-block
+		cutoff_mod[sb] = v.mod[VSTFX_MOD_DST_CUTOFF];
+		if (audio.count) {
+			float dst[VSTFX_MOD_DST_COUNT] = {0.0f};
+			src[VSTFX_MOD_SRC_ENV] = v.env * (1.0f / VSTFX_VOICE_LEVEL);
+			src[VSTFX_MOD_SRC_LFO] = ctx.lfo[start + n - 1];
+			audio.apply(src, dst);
+			cutoff_mod[sb] += dst[VSTFX_MOD_DST_CUTOFF];
+		}
+	}
+
+	if (v.env <= 0.0f || v.fade <= 0.0f) v.active = false;
+}
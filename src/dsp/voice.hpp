@@ -0,0 +1,145 @@
+#ifndef VSTFX_VOICE_H
+#define VSTFX_VOICE_H
+
+#include "filter.hpp"
+#include "halfband.hpp"
+#include "mod_matrix.hpp"
+#include "oscillator.hpp"
+#include "quality.hpp"
+#include "voice_alloc.hpp"
+#include <cstdint>
+
+#define VSTFX_MAX_VOICES 16
+static_assert(VSTFX_MAX_VOICES <= VSTFX_ALLOC_MAX_VOICES, "too many voices");
+
+// voices are rendered and filtered this many frames at a time
+#define VSTFX_VOICE_CHUNK 64
+#define VSTFX_VOICE_SUBBLOCKS (VSTFX_VOICE_CHUNK / VSTFX_MOD_BLOCK)
+
+// envelope level right after note on
+#define VSTFX_VOICE_LEVEL 0.8f
+
+struct VSTFX_Voice {
+	bool active{false};
+	bool released{false};
+	int32_t note{0};
+	float velocity{0.0f};
+
+	VSTFX_UnisonOsc osc;
+
+	// kept from note on to the end, so a quality change never glitches
+	// a sounding note
+	VSTFX_Quality quality{VSTFX_QUALITY_REALTIME};
+	VSTFX_Halfband decimator[2]; // left, right, offline only
+
+	float env{0.0f};  // decays linearly from VSTFX_VOICE_LEVEL
+	float fade{1.0f}; // falls to 0 after note off
+
+	// the amplitude for this sample, then envelope and fade move on
+	float envelope(float decay, float fade_step) {
+		float amp = env * fade;
+		env -= decay;
+		if (env < 0.0f) env = 0.0f;
+		if (released) {
+			fade -= fade_step;
+			if (fade < 0.0f) fade = 0.0f;
+		}
+		return amp;
+	}
+
+	// block rate destinations, as reached at the end of the last sub-block
+	float mod[VSTFX_MOD_DST_COUNT];
+
+	VSTFX_FilterState filter;
+};
+
+// shared by all voices for one render() call
+struct VSTFX_VoiceContext {
+	const float *lfo; // one value per frame, -1..1
+	float release;	  // envelope decay per second
+	float modwheel;	  // 0..1
+	VSTFX_Waveform wave;
+
+	VSTFX_FilterType filter;
+	float cutoff; // octaves above VSTFX_FILTER_MIN_HZ
+	float resonance;
+};
+
+/*!
+ * \brief Polyphonic unison voices, modulated through a VSTFX_ModMatrix.
+ *
+ * Runs on the audio thread only, apart from the matrix's editor side.
+ */
+class VSTFX_VoiceEngine {
+public:
+	VSTFX_VoiceEngine();
+
+	void setSampleRate(float sr);
+
+	/*!
+	 * \brief Unison settings for the notes that start from now on.
+	 */
+	void setUnison(int32_t count, float detune, float spread);
+
+	/*!
+	 * \brief Poly, mono or legato, and who gets stolen in poly. Leaving
+	 * poly releases every voice.
+	 */
+	void setMode(VSTFX_VoiceMode mode, VSTFX_StealPolicy policy);
+
+	/*!
+	 * \brief Kernels for the notes that start from now on. Offline, their
+	 * oscillators run at twice the rate and are decimated with a
+	 * VSTFX_Halfband.
+	 */
+	void setQuality(VSTFX_Quality q) { quality = q; }
+
+	void noteOn(int32_t note, int32_t velocity);
+	void noteOff(int32_t note);
+
+	/*!
+	 * \brief Adds every sounding voice to `left` and `right`.
+	 *
+	 * Voices are rendered VSTFX_FILTER_LANES at a time into interleaved
+	 * lanes, so the filter runs on all of them at once, left and right
+	 * side by side.
+	 */
+	void render(float *left, float *right, int32_t frames,
+				const VSTFX_VoiceContext &ctx);
+
+	VSTFX_ModMatrix *getMatrix() { return &matrix; }
+	int32_t getActiveVoices() const;
+
+private:
+	void startVoice(int32_t index, int32_t note, int32_t velocity);
+	void releaseVoice(int32_t index);
+
+	/*!
+	 * \brief Renders up to VSTFX_VOICE_CHUNK stereo frames, left into
+	 * every `stride`-th float of `out` and right VSTFX_FILTER_LANES
+	 * floats after it, and the cutoff modulation at the end of each
+	 * sub-block into `cutoff_mod`.
+	 */
+	template <VSTFX_Quality Q>
+	void renderVoice(VSTFX_Voice &v, float *out, int32_t stride,
+					 int32_t frames, const VSTFX_VoiceContext &ctx,
+					 float *cutoff_mod);
+
+	VSTFX_Voice voices[VSTFX_MAX_VOICES];
+	VSTFX_VoiceAllocator alloc{VSTFX_MAX_VOICES};
+	VSTFX_ModMatrix matrix;
+	VSTFX_VoiceFilter filter;
+
+	float sample_rate{44100.0f};
+	float fade_step{1.0f}; // per sample after note off
+	uint32_t note_counter{0}; // seeds the unison phases
+
+	VSTFX_VoiceMode mode{VSTFX_VOICE_POLY};
+	VSTFX_NoteStack keys; // mono and legato only
+
+	int32_t unison{1};
+	float detune{0.0f}, spread{0.0f};
+	VSTFX_Quality quality{VSTFX_QUALITY_REALTIME};
+};
+
+#endif
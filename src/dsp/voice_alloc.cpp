@@ -0,0 +1,171 @@
+#include "voice_alloc.hpp"
+
+#include "../util/bits.hpp"
+#include <cmath>
+
+VSTFX_VoiceAllocator::VSTFX_VoiceAllocator(int32_t voices) {
+	all = voices >= 32 ? ~0u : (1u << voices) - 1;
+	free_mask = all;
+	for (int32_t v = 0; v < VSTFX_ALLOC_MAX_VOICES; v++) {
+		voice_note[v] = -1;
+		prev[v] = next[v] = -1;
+	}
+}
+
+// -------- Lists --------
+
+void VSTFX_VoiceAllocator::pushBack(List &list, int32_t voice) {
+	prev[voice] = list.tail;
+	next[voice] = -1;
+	if (list.tail >= 0) {
+		next[list.tail] = (int8_t)voice;
+	} else {
+		list.head = (int8_t)voice;
+	}
+	list.tail = (int8_t)voice;
+}
+
+void VSTFX_VoiceAllocator::remove(List &list, int32_t voice) {
+	if (prev[voice] >= 0) {
+		next[prev[voice]] = next[voice];
+	} else {
+		list.head = next[voice];
+	}
+	if (next[voice] >= 0) {
+		prev[next[voice]] = prev[voice];
+	} else {
+		list.tail = prev[voice];
+	}
+	prev[voice] = next[voice] = -1;
+}
+
+// -------- Buckets --------
+
+void VSTFX_VoiceAllocator::Buckets::set(int32_t voice, int32_t bucket) {
+	mask[of[voice]] &= ~(1u << voice);
+	of[voice] = (uint8_t)bucket;
+	mask[bucket] |= 1u << voice;
+}
+
+int32_t VSTFX_VoiceAllocator::Buckets::lowest(uint32_t among) const {
+	for (int32_t b = 0; b < VSTFX_ALLOC_BUCKETS; b++) {
+		uint32_t m = mask[b] & among;
+		if (m) return VSTFX_LowestBit(m);
+	}
+	return -1;
+}
+
+// -------- Voices --------
+
+void VSTFX_VoiceAllocator::detach(int32_t voice) {
+	uint32_t bit = 1u << voice;
+	if (held_mask & bit) remove(held, voice);
+	if (released_mask & bit) remove(released, voice);
+	held_mask &= ~bit;
+	released_mask &= ~bit;
+	free_mask &= ~bit;
+
+	if (voice_note[voice] >= 0) note_mask[voice_note[voice]] &= ~bit;
+	voice_note[voice] = -1;
+	level.clear(voice);
+	velocity.clear(voice);
+}
+
+int32_t VSTFX_VoiceAllocator::steal(int32_t note) {
+	uint32_t active = getActive();
+
+	switch (policy) {
+		case VSTFX_STEAL_QUIETEST:
+			return level.lowest(active);
+		case VSTFX_STEAL_SAME_NOTE:
+			if (note_mask[note]) return VSTFX_LowestBit(note_mask[note]);
+			break;
+		case VSTFX_STEAL_LOWEST_PRIORITY:
+			if (released.head >= 0) return released.head;
+			return velocity.lowest(held_mask);
+		default:
+			break;
+	}
+
+	return released.head >= 0 ? released.head : held.head;
+}
+
+int32_t VSTFX_VoiceAllocator::allocate(int32_t note, int32_t vel) {
+	int32_t voice =
+		free_mask & all ? VSTFX_LowestBit(free_mask & all) : steal(note);
+	assign(voice, note, vel);
+	return voice;
+}
+
+void VSTFX_VoiceAllocator::assign(int32_t voice, int32_t note, int32_t vel) {
+	detach(voice);
+
+	uint32_t bit = 1u << voice;
+	held_mask |= bit;
+	pushBack(held, voice);
+	voice_note[voice] = (int8_t)note;
+	note_mask[note] |= bit;
+
+	// until the first block reports a level, assume the velocity's
+	int32_t bucket = vel * VSTFX_ALLOC_BUCKETS / 128;
+	velocity.set(voice, bucket);
+	level.set(voice, bucket);
+}
+
+void VSTFX_VoiceAllocator::release(int32_t voice) {
+	uint32_t bit = 1u << voice;
+	if (!(held_mask & bit)) return;
+
+	remove(held, voice);
+	held_mask &= ~bit;
+	released_mask |= bit;
+	pushBack(released, voice);
+}
+
+void VSTFX_VoiceAllocator::free(int32_t voice) {
+	if (free_mask & (1u << voice)) return;
+	detach(voice);
+	free_mask |= 1u << voice;
+}
+
+void VSTFX_VoiceAllocator::setLevel(int32_t voice, float lvl) {
+	// 6 dB per bucket, the top one from -6 dB up
+	int32_t exponent = 0;
+	if (lvl > 0.0f) frexpf(lvl, &exponent);
+	int32_t bucket = lvl > 0.0f ? VSTFX_ALLOC_BUCKETS - 1 + exponent : 0;
+	if (bucket < 0) bucket = 0;
+	if (bucket >= VSTFX_ALLOC_BUCKETS) bucket = VSTFX_ALLOC_BUCKETS - 1;
+	level.set(voice, bucket);
+}
+
+// -------- Note stack --------
+
+VSTFX_NoteStack::VSTFX_NoteStack() {
+	for (int32_t n = 0; n < 128; n++) {
+		below[n] = above[n] = -1;
+		velocity[n] = 0;
+	}
+}
+
+void VSTFX_NoteStack::push(int32_t note, int32_t vel) {
+	remove(note);
+	velocity[note] = (int8_t)(vel > 0 ? vel : 1);
+	below[note] = head;
+	above[note] = -1;
+	if (head >= 0) above[head] = (int8_t)note;
+	head = (int8_t)note;
+}
+
+void VSTFX_NoteStack::remove(int32_t note) {
+	if (!velocity[note]) return;
+
+	if (above[note] >= 0) {
+		below[above[note]] = below[note];
+	} else {
+		head = below[note];
+	}
+	if (below[note] >= 0) above[below[note]] = above[note];
+
+	below[note] = above[note] = -1;
+	velocity[note] = 0;
+}
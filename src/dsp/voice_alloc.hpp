@@ -0,0 +1,119 @@
+#ifndef VSTFX_VOICE_ALLOC_H
+#define VSTFX_VOICE_ALLOC_H
+
+#include <cstdint>
+
+// voice sets are 32-bit masks
+#define VSTFX_ALLOC_MAX_VOICES 32
+
+// loudness and velocity classes for the quietest and softest steals
+#define VSTFX_ALLOC_BUCKETS 8
+
+enum VSTFX_VoiceMode {
+	VSTFX_VOICE_POLY = 0,
+	VSTFX_VOICE_MONO,	// one voice, retriggered by every note
+	VSTFX_VOICE_LEGATO, // one voice, overlapping notes only change pitch
+
+	VSTFX_VOICE_MODE_COUNT
+};
+
+// which voice a note on takes when none is free
+enum VSTFX_StealPolicy {
+	VSTFX_STEAL_OLDEST = 0,	 // longest released, else longest held
+	VSTFX_STEAL_QUIETEST,	 // lowest level at the end of the last block
+	VSTFX_STEAL_SAME_NOTE,	 // one playing the same note, else oldest
+	VSTFX_STEAL_LOWEST_PRIORITY, // released, else the softest velocity
+
+	VSTFX_STEAL_POLICY_COUNT
+};
+
+/*!
+ * \brief Decides which voice plays a note, in constant time.
+ *
+ * Voices sit in free, held and released bitmasks, and on intrusive lists
+ * in the order they were started or released. Per note masks answer note
+ * offs and same note steals, per bucket masks quietest and softest steals.
+ * Every decision is a lowest set bit or a list head, never a scan.
+ */
+class VSTFX_VoiceAllocator {
+public:
+	explicit VSTFX_VoiceAllocator(int32_t voices);
+
+	void setPolicy(VSTFX_StealPolicy p) { policy = p; }
+
+	/*!
+	 * \brief A free voice, or one stolen by the policy, marked as held.
+	 */
+	int32_t allocate(int32_t note, int32_t velocity);
+
+	/*!
+	 * \brief Restarts a particular voice as held, wherever it was.
+	 */
+	void assign(int32_t voice, int32_t note, int32_t velocity);
+
+	// note off: held to released
+	void release(int32_t voice);
+	// silent: back to free
+	void free(int32_t voice);
+
+	// for quietest steals, 0..1
+	void setLevel(int32_t voice, float level);
+
+	uint32_t getActive() const { return all & ~free_mask; }
+	uint32_t getHeld(int32_t note) const {
+		return note_mask[note] & held_mask;
+	}
+
+private:
+	int32_t steal(int32_t note);
+	void detach(int32_t voice);
+
+	struct List {
+		int8_t head{-1}, tail{-1};
+	};
+	void pushBack(List &list, int32_t voice);
+	void remove(List &list, int32_t voice);
+
+	struct Buckets {
+		uint32_t mask[VSTFX_ALLOC_BUCKETS]{};
+		uint8_t of[VSTFX_ALLOC_MAX_VOICES]{};
+
+		void set(int32_t voice, int32_t bucket);
+		void clear(int32_t voice) { mask[of[voice]] &= ~(1u << voice); }
+		int32_t lowest(uint32_t among) const; // -1 if none
+	};
+
+	VSTFX_StealPolicy policy{VSTFX_STEAL_OLDEST};
+
+	uint32_t all, free_mask, held_mask{0}, released_mask{0};
+	uint32_t note_mask[128]{};
+	int8_t voice_note[VSTFX_ALLOC_MAX_VOICES];
+
+	// a voice is on at most one list, so they share the links
+	int8_t prev[VSTFX_ALLOC_MAX_VOICES], next[VSTFX_ALLOC_MAX_VOICES];
+	List held, released;
+
+	Buckets level, velocity;
+};
+
+/*!
+ * \brief Keys held down, most recent on top, for mono and legato.
+ */
+class VSTFX_NoteStack {
+public:
+	VSTFX_NoteStack();
+
+	void push(int32_t note, int32_t velocity);
+	void remove(int32_t note);
+
+	// -1 when no key is down
+	int32_t top() const { return head; }
+	int32_t velocityOf(int32_t note) const { return velocity[note]; }
+
+private:
+	int8_t head{-1};
+	int8_t below[128], above[128];
+	int8_t velocity[128]; // 0 when not held
+};
+
+#endif
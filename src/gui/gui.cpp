@@ -3,31 +3,60 @@
 #include "../core_parameters.hpp"
 #include "SDL.h"
 #include "imgui_impl_sdl.h"
+#include "imgui_internal.h"
 #include "imgui_impl_sdlrenderer.h"
+#include <cstdio>
 
-VSTFX_GUI::VSTFX_GUI(VSTFX *e) { parent = e; }
+VSTFX_GUI::VSTFX_GUI(VSTFX *e)
+	: scope_history(VSTFX_SCOPE_HISTORY, 0.0f),
+	  fft_input(VSTFX_SCOPE_FFT_SIZE), spectrum_db(VSTFX_SCOPE_FFT_SIZE / 2) {
+	parent = e;
+}
 
 VSTFX_GUI::~VSTFX_GUI() {
+    close();
+    SDL_Quit();
+}
+
+void VSTFX_GUI::close() {
+    // stop the audio thread from feeding the scope
+    if (parent != NULL) parent->getAudioTap()->setEnabled(false);
+
+    if (!successful_init) return;
+    successful_init = false;
+
+    // don't leave the host waiting for the end of a gesture
+    if (parent != NULL) EndAllGestures();
+
+    // textures must go before the renderer does
+    knob_cache.Clear();
+    FreeImages();
+
     ImGui_ImplSDLRenderer_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
-    SDL_Quit();
+    renderer = NULL;
+    window = NULL;
+    SDL_VideoQuit();
 }
 
 bool VSTFX_GUI::getRect(Vst::ERect **erect) {
-	// set the editor's dimensions
-	static Vst::ERect r = {
-		0, 0, // position
-		500,  // width
-		500   // height
-	};
-	*erect = &r;
+	// set the editor's dimensions, these follow the UI scale
+	*erect = &rect;
 	return true;
 }
 
+bool VSTFX_GUI::getKnobCenter(int32_t index, float *x, float *y) const {
+    if (!successful_init || index < 0 || index >= PARAMETER_COUNT) return false;
+    if (knob_frames[index] != ImGui::GetFrameCount()) return false;
+    *x = knob_centers[index].x;
+    *y = knob_centers[index].y;
+    return true;
+}
+
 bool VSTFX_GUI::open(void *ptr) {
 	// initialize the GUI
 	bool vinit = SDL_VideoInit(NULL);
@@ -43,6 +72,29 @@ bool VSTFX_GUI::open(void *ptr) {
 					 "Unable to open window: %s\n", SDL_GetError());
 	}
 
+	InitRenderer(vinit);
+	return true;
+}
+
+bool VSTFX_GUI::openOffscreen(int width, int height) {
+	// the video driver is picked by the caller through SDL_VIDEODRIVER,
+	// e.g. "offscreen" or "dummy" on machines without a display
+	bool vinit = SDL_VideoInit(NULL);
+	if (vinit) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unable to init video: %s\n",
+					 SDL_GetError());
+	}
+
+	window = SDL_CreateWindow("VSTFX", 0, 0, width, height, SDL_WINDOW_HIDDEN);
+	if (!window) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+					 "Unable to open window: %s\n", SDL_GetError());
+	}
+
+	return InitRenderer(vinit);
+}
+
+bool VSTFX_GUI::InitRenderer(bool vinit) {
 	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
 	renderer = SDL_CreateRenderer(window, -1, 0);
 	if (!renderer) {
@@ -63,20 +115,30 @@ bool VSTFX_GUI::open(void *ptr) {
         // disable layout saving
         ImGui::GetIO().IniFilename = NULL;
 
+        // use the prebaked fonts at the scale closest to the display's
+        LoadBakedFonts();
+        int scale = ClosestScale(DisplayScale());
+        ApplyScale(scale);
+        if (scale != 0) ResizeToScale();
+
         // preload images
         for (int i = 0; i < (int)VSTFX_IMG_LEN; i++) {
             preloaded_images[(VSTFX_ImageID) i] = LoadImage((VSTFX_ImageID) i);
         }
 		// TODO: I want to do this but the image hides after hiding the window
 		// :(
+
+        // start receiving audio for the scope
+        if (parent != NULL) parent->getAudioTap()->setEnabled(true);
 	}
-	return true;
+	return successful_init;
 }
 
 void VSTFX_GUI::idle() {
     // update routine
-    fGain_value = parent->getParameter(kVolume);
-    fRelease_value = parent->getParameter(kRelease);
+    for (int i = 0; i < PARAMETER_COUNT; i++) {
+        param_values[i] = parent->getParameter(i);
+    }
 
     if (successful_init) {
         // inputs
@@ -84,6 +146,16 @@ void VSTFX_GUI::idle() {
             ImGui_ImplSDL2_ProcessEvent(&event);
         }
 
+        // keep the tap drained even while the scope tab is hidden
+        UpdateScope();
+
+        // scale changes have to happen between frames
+        if (pending_scale >= 0) {
+            ApplyScale(pending_scale);
+            ResizeToScale();
+            pending_scale = -1;
+        }
+
         // setup platform
         ImGui_ImplSDLRenderer_NewFrame();
         ImGui_ImplSDL2_NewFrame();
@@ -99,6 +171,9 @@ void VSTFX_GUI::idle() {
 
         RenderGUI();
 
+        // report this frame's edits to the host, once per parameter
+        if (parent != NULL) FlushAutomation();
+
         ImGui::Render();
 
         // to SDL backbuffer
@@ -128,6 +203,14 @@ void VSTFX_GUI::RenderGUI() {
     if (ImGui::BeginMenuBar()) {
         if (ImGui::MenuItem("File", NULL, false, false)){}
         if (ImGui::MenuItem("Edit", NULL, false, false)){}
+        if (ImGui::BeginMenu("View")) {
+            for (int i = 0; i < GetScaleCount(); i++) {
+                char label[16];
+                snprintf(label, sizeof(label), "Zoom %d%%", (int)(GetScaleAt(i) * 100));
+                if (ImGui::MenuItem(label, NULL, i == ui_scale)) setScale(i);
+            }
+            ImGui::EndMenu();
+        }
         if (ImGui::MenuItem("About", NULL, false, false)){}
         ImGui::EndMenuBar();
     }
@@ -159,17 +242,40 @@ void VSTFX_GUI::RenderGUI() {
         {
             if (ImGui::BeginTabItem("Basic controls"))
             {
-                if (MyKnob((const char*)"Gain", &fGain_value, (float) 0.0, (float) 1.0)) {
-                    if (parent != NULL) {
-                        parent->setParameter(kVolume, fGain_value);
-                    }
-                }
-                ImGui::SameLine();
-                if (MyKnob((const char*)"Release", &fRelease_value, (float) 0.0, (float) 1.0)) {
+                // one knob per parameter, straight from the registry
+                for (int i = 0; i < PARAMETER_COUNT; i++) {
+                    ImGuiID knob_id = ImGui::GetID(paramTable[i].name);
+                    bool changed = Knob(paramTable[i].name, &param_values[i], (float) 0.0, (float) 1.0);
+                    ImVec2 knob_min = ImGui::GetItemRectMin(), knob_max = ImGui::GetItemRectMax();
+                    knob_centers[i] = ImVec2((knob_min.x + knob_max.x) * 0.5f, (knob_min.y + knob_max.y) * 0.5f);
+                    knob_frames[i] = ImGui::GetFrameCount();
+
                     if (parent != NULL) {
-                        parent->setParameter(kRelease, fRelease_value);
+                        UpdateGesture(i, ImGui::GetActiveID() == knob_id);
+                        if (changed) ParameterEdited(i, param_values[i]);
+                        MidiLearnMenu(i);
                     }
+
+                    // wrap once the next knob would not fit
+                    float next_right = ImGui::GetItemRectMax().x + ImGui::GetStyle().ItemSpacing.x + ImGui::GetItemRectSize().x;
+                    if (next_right < ImGui::GetWindowPos().x + ImGui::GetWindowContentRegionMax().x) ImGui::SameLine();
                 }
+                if (parent != NULL) RenderMeters();
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Scope"))
+            {
+                RenderScope();
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Modulation"))
+            {
+                if (parent != NULL) RenderModMatrix();
+                ImGui::EndTabItem();
+            }
+            if (ImGui::BeginTabItem("Sampler"))
+            {
+                if (parent != NULL) RenderSampler();
                 ImGui::EndTabItem();
             }
             ImGui::EndTabBar();
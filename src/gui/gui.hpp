@@ -4,32 +4,114 @@
 #include "SDL_events.h"
 #include "SDL_render.h"
 #include "gui_image.hpp"
+#include "gui_knob_cache.hpp"
 #include "imgui.h"
 #include <map>
+#include <vector>
 
+#include "../dsp/fft.hpp"
+#include "../dsp/meter.hpp"
+
+#include "../core_parameters.hpp"
 #include "../vst.h"
 
 class VSTFX;
 
+// decimated samples kept for the scope, and the analyzer resolution
+#define VSTFX_SCOPE_HISTORY 2048
+#define VSTFX_SCOPE_FFT_SIZE 1024
+
+// editor size at a UI scale of 1
+#define VSTFX_EDITOR_WIDTH 500
+#define VSTFX_EDITOR_HEIGHT 500
+
+enum VSTFX_KnobStyle {
+	VSTFX_KNOB_PROCEDURAL = 0, // tessellated every frame
+	VSTFX_KNOB_CACHED		   // drawn from a pre-rendered filmstrip
+};
+
 // -------- GUI Class --------
 
 class VSTFX_GUI {
 public:
 	// API overrides
 	VSTFX_GUI(VSTFX *e);
-	~VSTFX_GUI();
+	virtual ~VSTFX_GUI();
 	virtual bool open(void *ptr);
+	virtual void close();
 	virtual bool getRect(Vst::ERect **rect);
 	virtual void idle();
 
+	/*!
+	 * \brief Opens the editor in a hidden window owned by SDL instead of
+	 * one provided by the host, used for headless benchmarking.
+	 */
+	bool openOffscreen(int width, int height);
+
+	/*!
+	 * \brief The SDL window the editor renders to, NULL before opening.
+	 */
+	SDL_Window *getWindow() { return window; }
+
+	/*!
+	 * \brief Selects how knobs are drawn, mostly useful for benchmarking.
+	 */
+	void setKnobStyle(VSTFX_KnobStyle style) { knob_style = style; }
+
+	/*!
+	 * \brief Selects one of the prebaked UI scales, applied on the next
+	 * frame and reported to the host through audioMasterSizeWindow.
+	 */
+	void setScale(int index) { pending_scale = index; }
+
+	/*!
+	 * \brief Centre of the knob of parameter `index` in window coordinates,
+	 * as laid out in the last frame. False if that frame did not draw it.
+	 */
+	bool getKnobCenter(int32_t index, float *x, float *y) const;
+
 protected:
 	// custom functions
-	void RenderGUI();
+	virtual void RenderGUI();
+
+	// normalized parameter values, refreshed from the attached VST every idle
+	float param_values[PARAMETER_COUNT]{};
+
+	// where each knob was drawn, and in which ImGui frame
+	ImVec2 knob_centers[PARAMETER_COUNT]{};
+	int knob_frames[PARAMETER_COUNT]{};
 
-	// corresponds to the attached VST's default values
-	float fGain_value{0.5}, fRelease_value{0.0};
+	// gui_widgets.cpp
+
+	/*!
+	 * \brief Draws a knob in the currently selected style.
+	 */
+	bool Knob(const char *label, float *p_value, float v_min, float v_max);
+
+	static bool MyKnob(const char *label, float *p_value, float v_min,
+					   float v_max);
+
+	/*!
+	 * \brief Same as MyKnob, but drawn as a single quad from the knob cache.
+	 */
+	bool MyCachedKnob(const char *label, float *p_value, float v_min,
+					  float v_max);
+
+	/*!
+	 * \brief Draws the output meters, decaying them by the frame time.
+	 */
+	void RenderMeters();
+
+	// displayed meter levels in dB, after decay
+	float meter_peak_db[VSTFX_METER_CHANNELS]{-90.0f, -90.0f};
+	float meter_rms_db[VSTFX_METER_CHANNELS]{-90.0f, -90.0f};
 
 private:
+	/*!
+	 * \brief Creates the renderer and ImGui context once a window exists.
+	 */
+	bool InitRenderer(bool vinit);
+
 	bool m_show_some_panel{true};
 	bool successful_init{false};
 	SDL_Event event{};
@@ -47,6 +129,9 @@ private:
 	 */
 	std::map<VSTFX_ImageID, VSTFX_Image *> preloaded_images;
 
+	VSTFX_KnobStyle knob_style{VSTFX_KNOB_CACHED};
+	VSTFX_KnobCache knob_cache;
+
 	// gui_image.cpp
 
 	/*!
@@ -78,10 +163,120 @@ private:
 	 */
 	VSTFX_Image *FindPreloadedImage(VSTFX_ImageID id);
 
-	// gui_widgets.cpp
+	/*!
+	 * \brief Releases every preloaded image and its texture.
+	 */
+	void FreeImages();
 
-	static bool MyKnob(const char *label, float *p_value, float v_min,
-					   float v_max);
+	// gui_automation.cpp
+
+	// knob gestures in progress, bracketed by begin/end edit
+	bool param_editing[PARAMETER_COUNT]{};
+
+	// parameters changed this frame, reported once at the end of it
+	bool automate_pending[PARAMETER_COUNT]{};
+	int32_t pending_list[PARAMETER_COUNT];
+	int32_t pending_count{0};
+
+	/*!
+	 * \brief Tracks whether a parameter's control is being dragged and
+	 * tells the host when a gesture starts or ends.
+	 */
+	void UpdateGesture(int32_t index, bool active);
+
+	/*!
+	 * \brief Applies an edited value right away, the host hears about it
+	 * in FlushAutomation.
+	 */
+	void ParameterEdited(int32_t index, float value);
+
+	/*!
+	 * \brief Sends at most one audioMasterAutomate per changed parameter.
+	 */
+	void FlushAutomation();
+
+	/*!
+	 * \brief Closes any open gesture, e.g. when the editor goes away.
+	 */
+	void EndAllGestures();
+
+	/*!
+	 * \brief Right click menu of a parameter's control: MIDI learn and
+	 * forget. Call right after the control.
+	 */
+	void MidiLearnMenu(int32_t index);
+
+	// gui_font.cpp
+
+	Vst::ERect rect{0, 0, VSTFX_EDITOR_HEIGHT, VSTFX_EDITOR_WIDTH};
+	int ui_scale{0};
+	int pending_scale{-1};
+
+	/*!
+	 * \brief Installs the build-time font atlas into the ImGui context.
+	 */
+	void LoadBakedFonts();
+
+	/*!
+	 * \brief Index of the prebaked scale closest to `scale`.
+	 */
+	static int ClosestScale(float scale);
+
+	/*!
+	 * \brief DPI scale of the display the editor window is on.
+	 */
+	float DisplayScale();
+
+	/*!
+	 * \brief Switches font, style and editor size to a prebaked scale.
+	 * Must be called outside of a frame.
+	 */
+	void ApplyScale(int index);
+
+	/*!
+	 * \brief Tells the host about the editor size after a scale change.
+	 */
+	void ResizeToScale();
+
+	float GetScale();
+	static int GetScaleCount();
+	static float GetScaleAt(int index);
+
+	// gui_scope.cpp
+
+	VSTFX_FFT fft{VSTFX_SCOPE_FFT_SIZE};
+	std::vector<float> scope_history; // circular, oldest at scope_pos
+	size_t scope_pos{0};
+	bool scope_dirty{false};
+	std::vector<float> fft_input, spectrum_db;
+	std::vector<ImVec2> scope_points;
+
+	/*!
+	 * \brief Pulls whatever the audio thread tapped since the last frame.
+	 */
+	void UpdateScope();
+
+	/*!
+	 * \brief Draws the oscilloscope and spectrum analyzer.
+	 */
+	void RenderScope();
+
+	// gui_mod_matrix.cpp
+
+	/*!
+	 * \brief Table of modulation slots: source, destination, amount and
+	 * tier.
+	 */
+	void RenderModMatrix();
+
+	// gui_sampler.cpp
+
+	char sampler_path[1024]{};
+
+	/*!
+	 * \brief Library loading and streaming statistics.
+	 */
+	void RenderSampler();
 };
 
 #endif
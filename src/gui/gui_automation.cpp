@@ -0,0 +1,86 @@
+#include "gui.hpp"
+#include "../core.hpp"
+
+void VSTFX_GUI::UpdateGesture(int32_t index, bool active) {
+    if (active == param_editing[index]) return;
+    param_editing[index] = active;
+
+    if (active) {
+        parent->beginEdit(index);
+    } else {
+        // the last value of the gesture must land before it ends
+        if (automate_pending[index]) {
+            parent->automate(index, param_values[index]);
+            automate_pending[index] = false;
+        }
+        parent->endEdit(index);
+    }
+}
+
+void VSTFX_GUI::ParameterEdited(int32_t index, float value) {
+    parent->setParameter(index, value);
+
+    if (!automate_pending[index]) {
+        automate_pending[index] = true;
+        pending_list[pending_count++] = index;
+    }
+}
+
+void VSTFX_GUI::FlushAutomation() {
+    for (int32_t i = 0; i < pending_count; i++) {
+        int32_t index = pending_list[i];
+        // may have been sent already by a gesture ending this frame
+        if (!automate_pending[index]) continue;
+
+        parent->automate(index, param_values[index]);
+        automate_pending[index] = false;
+    }
+    pending_count = 0;
+}
+
+void VSTFX_GUI::EndAllGestures() {
+    FlushAutomation();
+    for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+        UpdateGesture(i, false);
+    }
+}
+
+// -------- MIDI learn --------
+
+void VSTFX_GUI::MidiLearnMenu(int32_t index) {
+    VSTFX_MidiMap* map = parent->getMidiMap();
+    bool learning = map->learning() == index;
+
+    // outline the control until a controller has been moved
+    if (learning) {
+        ImGui::GetWindowDrawList()->AddRect(ImGui::GetItemRectMin(), ImGui::GetItemRectMax(), ImGui::GetColorU32(ImGuiCol_PlotHistogram), 4.0f, 0, 2.0f);
+    }
+
+    if (!ImGui::BeginPopupContextItem(paramTable[index].name)) return;
+
+    VSTFX_MidiSource src = map->getSource(index);
+    switch (src.type) {
+        case VSTFX_MIDI_SOURCE_CC:
+            ImGui::TextDisabled("CC %d, channel %d", src.number, src.channel + 1);
+            break;
+        case VSTFX_MIDI_SOURCE_NRPN:
+            ImGui::TextDisabled("NRPN %d:%d, channel %d", src.number >> 7, src.number & 0x7f, src.channel + 1);
+            break;
+        case VSTFX_MIDI_SOURCE_PITCH_BEND:
+            ImGui::TextDisabled("Pitch bend, channel %d", src.channel + 1);
+            break;
+        default:
+            ImGui::TextDisabled("No MIDI mapping");
+            break;
+    }
+    ImGui::Separator();
+
+    if (ImGui::MenuItem("MIDI Learn", NULL, learning)) {
+        map->learn(learning ? -1 : index);
+    }
+    if (ImGui::MenuItem("Forget MIDI mapping", NULL, false, src.type != VSTFX_MIDI_SOURCE_NONE)) {
+        map->forget(index);
+    }
+
+    ImGui::EndPopup();
+}
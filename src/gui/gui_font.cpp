@@ -0,0 +1,98 @@
+#include "gui.hpp"
+#include "../core.hpp"
+#include "res/include/font_atlas.h"
+
+#include <cmath>
+
+void VSTFX_GUI::LoadBakedFonts() {
+    // hand the prebaked atlas to ImGui as if it had just built it, one
+    // font per scale sharing a single texture
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    atlas->Clear();
+    atlas->Flags |= ImFontAtlasFlags_NoMouseCursors | ImFontAtlasFlags_NoBakedLines;
+
+    size_t tex_size = (size_t)FONT_ATLAS_WIDTH * FONT_ATLAS_HEIGHT;
+    atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(tex_size);
+    memcpy(atlas->TexPixelsAlpha8, FONT_ATLAS, tex_size);
+    atlas->TexWidth = FONT_ATLAS_WIDTH;
+    atlas->TexHeight = FONT_ATLAS_HEIGHT;
+    atlas->TexUvScale = ImVec2(1.0f / FONT_ATLAS_WIDTH, 1.0f / FONT_ATLAS_HEIGHT);
+    atlas->TexUvWhitePixel = ImVec2(FONT_ATLAS_WHITE_U, FONT_ATLAS_WHITE_V);
+
+    for (unsigned int i = 0; i < FONT_ATLAS_FONT_COUNT; i++) {
+        const VSTFX_BakedFont& baked = FONT_ATLAS_FONTS[i];
+
+        ImFont* font = IM_NEW(ImFont);
+        font->ContainerAtlas = atlas;
+        font->FontSize = baked.size;
+        font->Ascent = baked.ascent;
+        font->Descent = baked.descent;
+        font->EllipsisChar = (ImWchar)baked.ellipsis_char;
+
+        font->Glyphs.reserve(baked.glyph_count);
+        for (unsigned int g = 0; g < baked.glyph_count; g++) {
+            const VSTFX_BakedGlyph& gl = FONT_ATLAS_GLYPHS[baked.first_glyph + g];
+            font->AddGlyph(NULL, (ImWchar)gl.codepoint,
+                           gl.x0, gl.y0, gl.x1, gl.y1,
+                           gl.u0, gl.v0, gl.u1, gl.v1,
+                           gl.advance_x);
+        }
+        font->BuildLookupTable();
+        atlas->Fonts.push_back(font);
+    }
+    atlas->TexReady = true;
+}
+
+int VSTFX_GUI::ClosestScale(float scale) {
+    int best = 0;
+    for (unsigned int i = 1; i < FONT_ATLAS_FONT_COUNT; i++) {
+        if (fabsf(FONT_ATLAS_FONTS[i].scale - scale) < fabsf(FONT_ATLAS_FONTS[best].scale - scale)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+float VSTFX_GUI::DisplayScale() {
+    float dpi;
+    if (window == NULL) return 1.0f;
+    if (SDL_GetDisplayDPI(SDL_GetWindowDisplayIndex(window), &dpi, NULL, NULL) != 0) {
+        return 1.0f;
+    }
+    return dpi / 96.0f;
+}
+
+void VSTFX_GUI::ApplyScale(int index) {
+    float scale = FONT_ATLAS_FONTS[index].scale;
+    ui_scale = index;
+
+    // only switches fonts within the atlas, nothing is rebuilt
+    ImGui::GetIO().FontDefault = ImGui::GetIO().Fonts->Fonts[index];
+
+    ImGuiStyle& style = ImGui::GetStyle();
+    style = ImGuiStyle();
+    style.ScaleAllSizes(scale);
+
+    rect.right = (int16_t)(VSTFX_EDITOR_WIDTH * scale);
+    rect.bottom = (int16_t)(VSTFX_EDITOR_HEIGHT * scale);
+}
+
+void VSTFX_GUI::ResizeToScale() {
+    // ask the host to resize its window, then follow along
+    if (parent != NULL) {
+        parent->hostCallback(Vst::audioMasterSizeWindow, rect.right, rect.bottom);
+    }
+    if (window != NULL) SDL_SetWindowSize(window, rect.right, rect.bottom);
+}
+
+float VSTFX_GUI::GetScale() {
+    return FONT_ATLAS_FONTS[ui_scale].scale;
+}
+
+int VSTFX_GUI::GetScaleCount() {
+    return (int)FONT_ATLAS_FONT_COUNT;
+}
+
+float VSTFX_GUI::GetScaleAt(int index) {
+    return FONT_ATLAS_FONTS[index].scale;
+}
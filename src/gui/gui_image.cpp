@@ -1,6 +1,9 @@
 #include "gui_image.hpp"
+#include "../util/asset_cache.hpp"
+#include "../util/trace.hpp"
 #include "SDL_log.h"
 #include "gui.hpp"
+#include <string>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_PNG
@@ -18,32 +21,53 @@ const unsigned int VSTFX_ImageSizes[VSTFX_IMG_LEN] = {
     IMGTEST_SIZE
 };
 
-VSTFX_Image* VSTFX_GUI::LoadImage(VSTFX_ImageID id) {
-    assert(id >= VSTFX_IMG_TEST);
-    assert(id < VSTFX_IMG_LEN);
-
-    VSTFX_Image* img = new VSTFX_Image;
-
-    img->id = id;
+VSTFX_ImagePixels::~VSTFX_ImagePixels() {
+    if (data != NULL) stbi_image_free(data);
+}
 
-    img->data = stbi_load_from_memory(
+static VSTFX_ImagePixels* DecodeImage(VSTFX_ImageID id) {
+    VSTFX_ImagePixels* px = new VSTFX_ImagePixels;
+    px->data = stbi_load_from_memory(
         VSTFX_ImageData[id],
         VSTFX_ImageSizes[id],
-        &img->width,
-        &img->height,
-        &img->channels,
+        &px->width,
+        &px->height,
+        &px->channels,
         STBI_rgb_alpha
         );
+    return px;
+}
 
-    if (img->data == NULL) {
+VSTFX_Image* VSTFX_GUI::LoadImage(VSTFX_ImageID id) {
+    assert(id >= VSTFX_IMG_TEST);
+    assert(id < VSTFX_IMG_LEN);
+
+    // decoded once for all editors, only the texture is this one's
+    std::shared_ptr<const VSTFX_ImagePixels> px =
+        VSTFX_AssetCache::Get<VSTFX_ImagePixels>(
+            "image/" + std::to_string((int)id),
+            [=] { return DecodeImage(id); }
+            );
+
+    if (px->data == NULL) {
         return NULL;
     }
 
+    VSTFX_Image* img = new VSTFX_Image;
+
+    img->id = id;
+    img->pixels = px;
+    img->data = px->data;
+    img->width = px->width;
+    img->height = px->height;
+    img->channels = px->channels;
+
     return img;
 }
 
 SDL_Texture* VSTFX_GUI::Image2Texture(VSTFX_Image* img, SDL_BlendMode blend_mode) {
     assert(img != NULL);
+    VSTFX_TraceSpan span("editor", "Image2Texture", "image", img->id);
 
     if (img->texture == NULL) {
         img->texture = SDL_CreateTexture(
@@ -127,3 +151,14 @@ VSTFX_Image* VSTFX_GUI::FindPreloadedImage(VSTFX_ImageID id) {
     }
     return NULL;
 }
+
+void VSTFX_GUI::FreeImages() {
+    for (auto& it : preloaded_images) {
+        VSTFX_Image* img = it.second;
+        if (img == NULL) continue;
+
+        if (img->texture != NULL) SDL_DestroyTexture(img->texture);
+        delete img;
+    }
+    preloaded_images.clear();
+}
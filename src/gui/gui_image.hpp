@@ -2,6 +2,7 @@
 #define VSTFX_GUI_IMAGE_H
 
 #include "SDL_render.h"
+#include <memory>
 
 // -------- Image list --------
 
@@ -11,12 +12,21 @@ enum VSTFX_ImageID {
 	VSTFX_IMG_LEN
 };
 
+// decoded RGBA, shared by every editor in the module
+struct VSTFX_ImagePixels {
+	unsigned char *data{NULL};
+	int width{0}, height{0}, channels{0};
+
+	~VSTFX_ImagePixels();
+};
+
 struct VSTFX_Image {
 	VSTFX_ImageID id;
-	unsigned char *data;
+	std::shared_ptr<const VSTFX_ImagePixels> pixels;
+	const unsigned char *data;
 	int width, height, channels;
 
-	SDL_Texture *texture;
+	SDL_Texture *texture; // this editor's, textures belong to a renderer
 
 	VSTFX_Image()
 		: data(NULL), texture(NULL), width(0), height(0), channels(0) {}
@@ -0,0 +1,110 @@
+#include "gui_knob_cache.hpp"
+#include "SDL_log.h"
+
+#include <cmath>
+
+VSTFX_KnobCache::~VSTFX_KnobCache() { Clear(); }
+
+void VSTFX_KnobCache::Clear() {
+	for (auto &s : strips) {
+		if (s.texture) SDL_DestroyTexture(s.texture);
+	}
+	strips.clear();
+}
+
+SDL_Texture *VSTFX_KnobCache::Get(SDL_Renderer *renderer, int radius,
+								  const VSTFX_KnobSkin &skin) {
+	for (auto &s : strips) {
+		if (s.radius == radius && s.skin == skin) return s.texture;
+	}
+
+	int size = radius * 2;
+	int width = size * 2;
+	int height = size * VSTFX_KNOB_FRAMES;
+
+	SDL_Texture *tx =
+		SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888,
+						  SDL_TEXTUREACCESS_STATIC, width, height);
+	if (!tx) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+					 "Unable to create knob texture: %s\n", SDL_GetError());
+		return NULL;
+	}
+	SDL_SetTextureBlendMode(tx, SDL_BLENDMODE_BLEND);
+
+	std::vector<Uint32> pixels(width * height, 0);
+	for (int f = 0; f < VSTFX_KNOB_FRAMES; f++) {
+		float t = (float)f / (VSTFX_KNOB_FRAMES - 1);
+		float angle = VSTFX_KnobAngle(t);
+		Uint32 *row = &pixels[f * size * width];
+		Rasterize(row, width, radius, angle, skin.cap, skin);
+		Rasterize(row + size, width, radius, angle, skin.cap_active, skin);
+	}
+
+	if (SDL_UpdateTexture(tx, NULL, pixels.data(), width * 4) != 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,
+					 "Unable to update knob texture: %s\n", SDL_GetError());
+	}
+
+	strips.push_back({radius, skin, tx});
+	return tx;
+}
+
+// -------- Software rasterizer --------
+
+static inline float Coverage(float d) {
+	// d: signed distance to the shape edge, negative inside
+	return d <= -0.5f ? 1.0f : (d >= 0.5f ? 0.0f : 0.5f - d);
+}
+
+// straight-alpha "over" of an ImU32 color with extra coverage
+static inline Uint32 Blend(Uint32 dst, ImU32 src, float cov) {
+	float sa = ((src >> IM_COL32_A_SHIFT) & 0xff) / 255.0f * cov;
+	if (sa <= 0.0f) return dst;
+	float da = ((dst >> IM_COL32_A_SHIFT) & 0xff) / 255.0f;
+	float oa = sa + da * (1.0f - sa);
+
+	Uint32 out = (Uint32)(oa * 255.0f + 0.5f) << IM_COL32_A_SHIFT;
+	const int shifts[3] = {IM_COL32_R_SHIFT, IM_COL32_G_SHIFT,
+						   IM_COL32_B_SHIFT};
+	for (int shift : shifts) {
+		float sc = ((src >> shift) & 0xff) / 255.0f;
+		float dc = ((dst >> shift) & 0xff) / 255.0f;
+		float oc = (sc * sa + dc * da * (1.0f - sa)) / oa;
+		out |= (Uint32)(oc * 255.0f + 0.5f) << shift;
+	}
+	return out;
+}
+
+void VSTFX_KnobCache::Rasterize(Uint32 *pixels, int pitch, int radius,
+								float angle, ImU32 cap,
+								const VSTFX_KnobSkin &skin) {
+	float r_outer = (float)radius;
+	float r_inner = r_outer * 0.40f;
+	float c = cosf(angle), s = sinf(angle);
+
+	// indicator line from the cap to the rim, 2px wide
+	float ax = r_outer + c * r_inner, ay = r_outer + s * r_inner;
+	float bx = r_outer + c * (r_outer - 2), by = r_outer + s * (r_outer - 2);
+	float abx = bx - ax, aby = by - ay;
+	float ab_len2 = abx * abx + aby * aby;
+
+	for (int y = 0; y < radius * 2; y++) {
+		for (int x = 0; x < radius * 2; x++) {
+			float px = x + 0.5f, py = y + 0.5f;
+			float dx = px - r_outer, dy = py - r_outer;
+			float d = sqrtf(dx * dx + dy * dy);
+
+			float h = ((px - ax) * abx + (py - ay) * aby) / ab_len2;
+			h = h < 0.0f ? 0.0f : (h > 1.0f ? 1.0f : h);
+			float lx = px - (ax + abx * h), ly = py - (ay + aby * h);
+			float d_line = sqrtf(lx * lx + ly * ly) - 1.0f;
+
+			Uint32 p = 0;
+			p = Blend(p, skin.background, Coverage(d - r_outer));
+			p = Blend(p, skin.indicator, Coverage(d_line));
+			p = Blend(p, cap, Coverage(d - r_inner));
+			pixels[y * pitch + x] = p;
+		}
+	}
+}
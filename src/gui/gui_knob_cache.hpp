@@ -0,0 +1,70 @@
+#ifndef VSTFX_GUI_KNOB_CACHE_H
+#define VSTFX_GUI_KNOB_CACHE_H
+
+#include "SDL_render.h"
+#include "imgui.h"
+#include <vector>
+
+// -------- Knob skin --------
+
+// the arc both knob renderers sweep, from 7:30 to 4:30
+#define VSTFX_KNOB_ANGLE_MIN (3.141592f * 0.75f)
+#define VSTFX_KNOB_ANGLE_MAX (3.141592f * 2.25f)
+
+// indicator angle for a knob at `t`, 0..1
+inline float VSTFX_KnobAngle(float t) {
+	return VSTFX_KNOB_ANGLE_MIN +
+		   (VSTFX_KNOB_ANGLE_MAX - VSTFX_KNOB_ANGLE_MIN) * t;
+}
+
+struct VSTFX_KnobSkin {
+	ImU32 background, indicator, cap, cap_active;
+
+	bool operator==(const VSTFX_KnobSkin &o) const {
+		return background == o.background && indicator == o.indicator &&
+			   cap == o.cap && cap_active == o.cap_active;
+	}
+};
+
+// -------- Knob filmstrip cache --------
+
+/*!
+ * \brief Pre-rendered knob frames, one filmstrip texture per size and skin.
+ *
+ * Each strip holds VSTFX_KNOB_FRAMES frames stacked vertically. The left
+ * column has the idle cap, the right column the active cap. A knob is then
+ * a single textured quad instead of two tessellated circles and a line.
+ */
+#define VSTFX_KNOB_FRAMES 64
+
+class VSTFX_KnobCache {
+public:
+	~VSTFX_KnobCache();
+
+	/*!
+	 * \brief Finds the filmstrip for a radius and skin, rasterizing it on
+	 * first use. Returns NULL if the texture could not be created.
+	 */
+	SDL_Texture *Get(SDL_Renderer *renderer, int radius,
+					 const VSTFX_KnobSkin &skin);
+
+	/*!
+	 * \brief Releases all textures, must be called before the renderer
+	 * they were created with is destroyed.
+	 */
+	void Clear();
+
+private:
+	struct Strip {
+		int radius;
+		VSTFX_KnobSkin skin;
+		SDL_Texture *texture;
+	};
+	std::vector<Strip> strips;
+
+	static void Rasterize(Uint32 *pixels, int pitch, int radius,
+						  float angle, ImU32 cap,
+						  const VSTFX_KnobSkin &skin);
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "gui.hpp"
+#include "../core.hpp"
+
+void VSTFX_GUI::RenderModMatrix() {
+    VSTFX_ModMatrix* matrix = parent->getVoiceEngine()->getMatrix();
+
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp;
+    if (!ImGui::BeginTable("mod_matrix", 4, flags)) return;
+
+    ImGui::TableSetupColumn("Source");
+    ImGui::TableSetupColumn("Destination");
+    ImGui::TableSetupColumn("Amount", ImGuiTableColumnFlags_WidthStretch, 1.5f);
+    ImGui::TableSetupColumn("Audio rate", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+
+    for (int32_t i = 0; i < VSTFX_MOD_SLOTS; i++) {
+        VSTFX_ModSlot slot = matrix->getSlot(i);
+        bool changed = false;
+
+        ImGui::PushID(i);
+        ImGui::TableNextRow();
+
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        changed |= ImGui::Combo("##source", &slot.source, modSourceNames, VSTFX_MOD_SRC_COUNT);
+
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        changed |= ImGui::Combo("##dest", &slot.dest, modDestNames, VSTFX_MOD_DST_COUNT);
+
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-FLT_MIN);
+        changed |= ImGui::SliderFloat("##amount", &slot.amount, -1.0f, 1.0f, "%.2f");
+
+        ImGui::TableNextColumn();
+        changed |= ImGui::Checkbox("##audio_rate", &slot.audio_rate);
+
+        // a full edit ring drops the change, the row shows the old value
+        if (changed) matrix->setSlot(i, slot);
+        ImGui::PopID();
+    }
+
+    ImGui::EndTable();
+}
@@ -0,0 +1,27 @@
+#include "gui.hpp"
+#include "../core.hpp"
+
+void VSTFX_GUI::RenderSampler() {
+    VSTFX_Sampler* sampler = parent->getSampler();
+
+    ImGui::TextUnformatted("SFZ map");
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    bool enter = ImGui::InputText("##sampler_path", sampler_path, sizeof(sampler_path), ImGuiInputTextFlags_EnterReturnsTrue);
+
+    // maps the files and decodes their heads, the rest streams later
+    if ((ImGui::Button("Load") || enter) && sampler_path[0]) sampler->load(sampler_path);
+
+    const char* error = sampler->getError();
+    if (error[0]) {
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", error);
+    } else if (sampler->getZoneCount()) {
+        ImGui::Text("%d zones, loaded in %.1f ms", sampler->getZoneCount(), sampler->getLoadMs());
+        ImGui::Text("%.1f MB in RAM, %.1f MB mapped", sampler->getResidentBytes() / 1048576.0, sampler->getMappedBytes() / 1048576.0);
+    } else {
+        ImGui::TextDisabled("No library, notes play the synth");
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Voices: %d", sampler->getActiveVoices());
+    ImGui::Text("Underruns: %u", sampler->getUnderruns());
+}
@@ -0,0 +1,82 @@
+#include "gui.hpp"
+#include "../core.hpp"
+
+#include <cmath>
+
+#define SCOPE_MIN_DB -90.0f
+#define SCOPE_MIN_FREQ 20.0f
+
+void VSTFX_GUI::UpdateScope() {
+    if (parent == NULL) return;
+
+    float block[512];
+    size_t n;
+    while ((n = parent->getAudioTap()->drain(block, 512)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            scope_history[scope_pos] = block[i];
+            scope_pos = (scope_pos + 1) & (VSTFX_SCOPE_HISTORY - 1);
+        }
+        scope_dirty = true;
+    }
+}
+
+void VSTFX_GUI::RenderScope() {
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    ImVec2 avail = ImGui::GetContentRegionAvail();
+    float half = (avail.y - ImGui::GetStyle().ItemSpacing.y) * 0.5f;
+    int width = (int)avail.x;
+    if (width < 2 || half < 2) return;
+
+    ImU32 bg = ImGui::GetColorU32(ImGuiCol_FrameBg);
+    ImU32 fg = ImGui::GetColorU32(ImGuiCol_PlotLines);
+
+    { // Oscilloscope, one point per pixel column at most
+        ImVec2 p0 = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(ImVec2(avail.x, half));
+        dl->AddRectFilled(p0, ImVec2(p0.x + avail.x, p0.y + half), bg);
+
+        int points = width < VSTFX_SCOPE_HISTORY ? width : VSTFX_SCOPE_HISTORY;
+        float mid = p0.y + half * 0.5f;
+        scope_points.resize(points);
+        for (int i = 0; i < points; i++) {
+            size_t idx = (scope_pos + (size_t)i * VSTFX_SCOPE_HISTORY / points) & (VSTFX_SCOPE_HISTORY - 1);
+            float s = scope_history[idx];
+            if (s > 1.0f) s = 1.0f;
+            if (s < -1.0f) s = -1.0f;
+            scope_points[i] = ImVec2(p0.x + avail.x * i / (points - 1), mid - s * half * 0.5f);
+        }
+        dl->AddPolyline(scope_points.data(), points, fg, 0, 1.0f);
+    }
+
+    { // Spectrum, log frequency axis
+        // only run the transform when new audio came in
+        if (scope_dirty) {
+            size_t start = scope_pos + VSTFX_SCOPE_HISTORY - VSTFX_SCOPE_FFT_SIZE;
+            for (int i = 0; i < VSTFX_SCOPE_FFT_SIZE; i++) {
+                fft_input[i] = scope_history[(start + i) & (VSTFX_SCOPE_HISTORY - 1)];
+            }
+            fft.magnitudes(fft_input.data(), spectrum_db.data());
+            scope_dirty = false;
+        }
+
+        ImVec2 p0 = ImGui::GetCursorScreenPos();
+        ImGui::Dummy(ImVec2(avail.x, half));
+        dl->AddRectFilled(p0, ImVec2(p0.x + avail.x, p0.y + half), bg);
+
+        float nyquist = parent->getAudioTap()->sampleRate(parent->getSampleRate()) * 0.5f;
+        int bins = VSTFX_SCOPE_FFT_SIZE / 2;
+        int points = width;
+        scope_points.resize(points);
+        for (int i = 0; i < points; i++) {
+            float f = SCOPE_MIN_FREQ * powf(nyquist / SCOPE_MIN_FREQ, (float)i / (points - 1));
+            int bin = (int)(f / nyquist * bins);
+            if (bin >= bins) bin = bins - 1;
+
+            float db = spectrum_db[bin];
+            if (db < SCOPE_MIN_DB) db = SCOPE_MIN_DB;
+            if (db > 0.0f) db = 0.0f;
+            scope_points[i] = ImVec2(p0.x + i, p0.y + half * (db / SCOPE_MIN_DB));
+        }
+        dl->AddPolyline(scope_points.data(), points, fg, 0, 1.0f);
+    }
+}
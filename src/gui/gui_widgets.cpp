@@ -1,29 +1,28 @@
 #include "gui.hpp"
+#include "../core.hpp"
 
 #include <cmath>
 
-bool VSTFX_GUI::MyKnob(const char* label, float* p_value, float v_min, float v_max) {
-    // https://github.com/ocornut/imgui/issues/942#issuecomment-268369298
+// shared by both knob renderers, radius at 100% scale
+#define KNOB_RADIUS 20.0f
 
-    // might replace this with a textured knob idk
+// follows the UI scale through the selected font
+static float KnobRadius() {
+    return floorf(KNOB_RADIUS * ImGui::GetFontSize() / 13.0f);
+}
 
+// handles input for a knob, returns true if the value changed
+static bool KnobBehavior(const char* label, float* p_value, float v_min, float v_max, bool* is_active) {
     ImGuiIO& io = ImGui::GetIO();
     ImGuiStyle& style = ImGui::GetStyle();
 
-    float radius_outer = 20.0f;
-    ImVec2 pos = ImGui::GetCursorScreenPos();
-    ImVec2 center = ImVec2(pos.x + radius_outer, pos.y + radius_outer);
     float line_height = ImGui::GetTextLineHeight();
-    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    float radius = KnobRadius();
 
-    float ANGLE_MIN = 3.141592f * 0.75f;
-    float ANGLE_MAX = 3.141592f * 2.25f;
-
-    ImGui::InvisibleButton(label, ImVec2(radius_outer*2, radius_outer*2 + line_height + style.ItemInnerSpacing.y));
+    ImGui::InvisibleButton(label, ImVec2(radius*2, radius*2 + line_height + style.ItemInnerSpacing.y));
     bool value_changed = false;
-    bool is_active = ImGui::IsItemActive();
-    bool is_hovered = ImGui::IsItemActive();
-    if (is_active && io.MouseDelta.y != 0.0f)
+    *is_active = ImGui::IsItemActive();
+    if (*is_active && io.MouseDelta.y != 0.0f)
     {
         float step = (v_max - v_min) / 200.0f;
         *p_value -= io.MouseDelta.y * step;
@@ -31,9 +30,35 @@ bool VSTFX_GUI::MyKnob(const char* label, float* p_value, float v_min, float v_m
         if (*p_value > v_max) *p_value = v_max;
         value_changed = true;
     }
+    return value_changed;
+}
+
+static void KnobTooltip(ImVec2 pos, float value) {
+    ImGuiStyle& style = ImGui::GetStyle();
+    float line_height = ImGui::GetTextLineHeight();
+
+    ImGui::SetNextWindowPos(ImVec2(pos.x - style.WindowPadding.x, pos.y - line_height - style.ItemInnerSpacing.y - style.WindowPadding.y));
+    ImGui::BeginTooltip();
+    ImGui::Text("%.3f", value);
+    ImGui::EndTooltip();
+}
+
+bool VSTFX_GUI::MyKnob(const char* label, float* p_value, float v_min, float v_max) {
+    // https://github.com/ocornut/imgui/issues/942#issuecomment-268369298
+
+    ImGuiStyle& style = ImGui::GetStyle();
+
+    float radius_outer = KnobRadius();
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImVec2 center = ImVec2(pos.x + radius_outer, pos.y + radius_outer);
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    bool is_active;
+    bool value_changed = KnobBehavior(label, p_value, v_min, v_max, &is_active);
+    bool is_hovered = is_active;
 
     float t = (*p_value - v_min) / (v_max - v_min);
-    float angle = ANGLE_MIN + (ANGLE_MAX - ANGLE_MIN) * t;
+    float angle = VSTFX_KnobAngle(t);
     float angle_cos = cosf(angle), angle_sin = sinf(angle);
     float radius_inner = radius_outer*0.40f;
     draw_list->AddCircleFilled(center, radius_outer, ImGui::GetColorU32(ImGuiCol_FrameBg), 16);
@@ -41,14 +66,88 @@ bool VSTFX_GUI::MyKnob(const char* label, float* p_value, float v_min, float v_m
     draw_list->AddCircleFilled(center, radius_inner, ImGui::GetColorU32(is_active ? ImGuiCol_FrameBgActive : is_hovered ? ImGuiCol_FrameBgHovered : ImGuiCol_FrameBg), 16);
     draw_list->AddText(ImVec2(pos.x, pos.y + radius_outer * 2 + style.ItemInnerSpacing.y), ImGui::GetColorU32(ImGuiCol_Text), label);
 
-    if (is_active || is_hovered)
-    {
-        ImGui::SetNextWindowPos(ImVec2(pos.x - style.WindowPadding.x, pos.y - line_height - style.ItemInnerSpacing.y - style.WindowPadding.y));
-        ImGui::BeginTooltip();
-        ImGui::Text("%.3f", *p_value);
-        ImGui::EndTooltip();
-    }
+    if (is_active || is_hovered) KnobTooltip(pos, *p_value);
+
+    return value_changed;
+}
+
+bool VSTFX_GUI::MyCachedKnob(const char* label, float* p_value, float v_min, float v_max) {
+    ImGuiStyle& style = ImGui::GetStyle();
+
+    VSTFX_KnobSkin skin = {
+        ImGui::GetColorU32(ImGuiCol_FrameBg),
+        ImGui::GetColorU32(ImGuiCol_SliderGrabActive),
+        ImGui::GetColorU32(ImGuiCol_FrameBg),
+        ImGui::GetColorU32(ImGuiCol_FrameBgActive)
+    };
+    float radius = KnobRadius();
+    SDL_Texture* strip = knob_cache.Get(renderer, (int)radius, skin);
+    if (strip == NULL) return MyKnob(label, p_value, v_min, v_max);
+
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    bool is_active;
+    bool value_changed = KnobBehavior(label, p_value, v_min, v_max, &is_active);
+
+    // pick the filmstrip frame closest to the value
+    float t = (*p_value - v_min) / (v_max - v_min);
+    int frame = (int)(t * (VSTFX_KNOB_FRAMES - 1) + 0.5f);
+    ImVec2 uv0 = ImVec2(is_active ? 0.5f : 0.0f, (float)frame / VSTFX_KNOB_FRAMES);
+    ImVec2 uv1 = ImVec2(uv0.x + 0.5f, (float)(frame + 1) / VSTFX_KNOB_FRAMES);
+
+    draw_list->AddImage(strip, pos, ImVec2(pos.x + radius*2, pos.y + radius*2), uv0, uv1);
+    draw_list->AddText(ImVec2(pos.x, pos.y + radius * 2 + style.ItemInnerSpacing.y), ImGui::GetColorU32(ImGuiCol_Text), label);
+
+    if (is_active) KnobTooltip(pos, *p_value);
 
     return value_changed;
 }
 
+bool VSTFX_GUI::Knob(const char* label, float* p_value, float v_min, float v_max) {
+    if (knob_style == VSTFX_KNOB_CACHED) {
+        return MyCachedKnob(label, p_value, v_min, v_max);
+    }
+    return MyKnob(label, p_value, v_min, v_max);
+}
+
+// -------- Meters --------
+
+#define METER_MIN_DB -60.0f
+#define METER_DECAY_DB_PER_SEC 24.0f
+
+static float LevelToDb(float level) {
+    return level > 1e-6f ? 20.0f * log10f(level) : -120.0f;
+}
+
+void VSTFX_GUI::RenderMeters() {
+    ImGuiStyle& style = ImGui::GetStyle();
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+    // ballistics live here, the audio thread only publishes raw levels
+    float decay = METER_DECAY_DB_PER_SEC * ImGui::GetIO().DeltaTime;
+
+    float bar_w = floorf(8.0f * ImGui::GetFontSize() / 13.0f);
+    float height = KnobRadius()*2 + ImGui::GetTextLineHeight() + style.ItemInnerSpacing.y;
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(ImVec2(VSTFX_METER_CHANNELS * (bar_w + 2), height));
+
+    // everything played since the last frame, not just the last block
+    float peaks[VSTFX_METER_CHANNELS], levels[VSTFX_METER_CHANNELS];
+    parent->getMeter()->read(peaks, levels);
+
+    for (int c = 0; c < VSTFX_METER_CHANNELS; c++) {
+        float peak = LevelToDb(peaks[c]);
+        float rms = LevelToDb(levels[c]);
+        meter_peak_db[c] = fmaxf(peak, meter_peak_db[c] - decay);
+        meter_rms_db[c] = fmaxf(rms, meter_rms_db[c] - decay);
+
+        float x = pos.x + c * (bar_w + 2);
+        float peak_t = 1.0f - fminf(fmaxf(meter_peak_db[c] / METER_MIN_DB, 0.0f), 1.0f);
+        float rms_t = 1.0f - fminf(fmaxf(meter_rms_db[c] / METER_MIN_DB, 0.0f), 1.0f);
+
+        draw_list->AddRectFilled(ImVec2(x, pos.y), ImVec2(x + bar_w, pos.y + height), ImGui::GetColorU32(ImGuiCol_FrameBg));
+        draw_list->AddRectFilled(ImVec2(x, pos.y + height * (1.0f - peak_t)), ImVec2(x + bar_w, pos.y + height), ImGui::GetColorU32(ImGuiCol_PlotHistogramHovered));
+        draw_list->AddRectFilled(ImVec2(x, pos.y + height * (1.0f - rms_t)), ImVec2(x + bar_w, pos.y + height), ImGui::GetColorU32(ImGuiCol_PlotHistogram));
+    }
+}
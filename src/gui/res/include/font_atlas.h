@@ -0,0 +1,30 @@
+#ifndef FONT_ATLAS_H
+#define FONT_ATLAS_H
+
+// generated by tools/font_bake.cpp
+
+struct VSTFX_BakedGlyph {
+	unsigned int codepoint;
+	float advance_x;
+	float x0, y0, x1, y1;
+	float u0, v0, u1, v1;
+};
+
+struct VSTFX_BakedFont {
+	float scale;
+	float size, ascent, descent;
+	unsigned int ellipsis_char;
+	unsigned int first_glyph, glyph_count;
+};
+
+extern const unsigned char FONT_ATLAS[];
+extern const unsigned int  FONT_ATLAS_WIDTH;
+extern const unsigned int  FONT_ATLAS_HEIGHT;
+extern const float         FONT_ATLAS_WHITE_U;
+extern const float         FONT_ATLAS_WHITE_V;
+
+extern const VSTFX_BakedFont  FONT_ATLAS_FONTS[];
+extern const unsigned int     FONT_ATLAS_FONT_COUNT;
+extern const VSTFX_BakedGlyph FONT_ATLAS_GLYPHS[];
+
+#endif // FONT_ATLAS_H
@@ -19,7 +19,17 @@ enum {
     MIDI_CC_MODWHEEL = 0x01,
     MIDI_CC_VOLUME = 0x07,
     MIDI_CC_PAN = 0x0a,
-    MIDI_CC_EXPRESSION = 0x0b
+    MIDI_CC_EXPRESSION = 0x0b,
+
+    // CC 0-31 carry the MSB of a 14-bit value, CC 32-63 the matching LSB
+    MIDI_CC_LSB_OFFSET = 0x20,
+
+    MIDI_CC_DATA_ENTRY_H = 0x06,
+    MIDI_CC_DATA_ENTRY_L = 0x26,
+    MIDI_CC_NRPN_L = 0x62,
+    MIDI_CC_NRPN_H = 0x63,
+    MIDI_CC_RPN_L = 0x64,
+    MIDI_CC_RPN_H = 0x65
 };
 
 #endif // MIDI_H
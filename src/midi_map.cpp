@@ -0,0 +1,266 @@
+#include "midi_map.hpp"
+#include "midi.hpp"
+
+#define NRPN_NULL 0x3fff
+
+static const float kScale7 = 1.0f / 127.0f;
+static const float kScale14 = 1.0f / 16383.0f;
+
+VSTFX_MidiMap::VSTFX_MidiMap() {
+	for (int32_t ch = 0; ch < VSTFX_MIDI_CHANNELS; ch++) {
+		for (int32_t cc = 0; cc < 128; cc++) {
+			cc_table[ch][cc] = {-1, VSTFX_CC_UNMAPPED};
+		}
+
+		// (N)RPN controllers are handled on every channel
+		cc_table[ch][MIDI_CC_DATA_ENTRY_H].kind = VSTFX_CC_DATA_MSB;
+		cc_table[ch][MIDI_CC_DATA_ENTRY_L].kind = VSTFX_CC_DATA_LSB;
+		cc_table[ch][MIDI_CC_NRPN_H].kind = VSTFX_CC_NRPN_MSB;
+		cc_table[ch][MIDI_CC_NRPN_L].kind = VSTFX_CC_NRPN_LSB;
+		cc_table[ch][MIDI_CC_RPN_H].kind = VSTFX_CC_RPN;
+		cc_table[ch][MIDI_CC_RPN_L].kind = VSTFX_CC_RPN;
+
+		bend_param[ch] = -1;
+		data_msb[ch] = 0;
+		nrpn_number[ch] = -1;
+		nrpn_param[ch] = -1;
+		for (int32_t i = 0; i < 32; i++)
+			cc_msb[ch][i] = 0;
+	}
+
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		values[i] = 0.0f;
+		sources[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+// -------- Incoming messages --------
+
+void VSTFX_MidiMap::controlChange(int32_t ch, int32_t cc, int32_t value) {
+	int32_t learn = learn_target.load(std::memory_order_relaxed);
+	if (learn >= 0) learnFrom(ch, cc, learn);
+
+	const CCSlot &slot = cc_table[ch][cc];
+	switch (slot.kind) {
+		case VSTFX_CC_7BIT:
+			setValue(slot.param, value * kScale7);
+			break;
+		case VSTFX_CC_14BIT_MSB:
+			// stands on its own until the LSB arrives
+			cc_msb[ch][cc] = (uint8_t)value;
+			setValue(slot.param, value * kScale7);
+			break;
+		case VSTFX_CC_14BIT_LSB: {
+			int32_t msb = cc_msb[ch][cc - MIDI_CC_LSB_OFFSET];
+			setValue(slot.param, ((msb << 7) | value) * kScale14);
+			break;
+		}
+
+		case VSTFX_CC_NRPN_MSB:
+		case VSTFX_CC_NRPN_LSB: {
+			int32_t number = nrpn_number[ch] < 0 ? 0 : nrpn_number[ch];
+			if (slot.kind == VSTFX_CC_NRPN_MSB) {
+				number = (number & 0x7f) | (value << 7);
+			} else {
+				number = (number & 0x3f80) | value;
+			}
+			nrpn_number[ch] = (int16_t)number;
+			nrpn_param[ch] = (int16_t)findNrpn(ch, number);
+			break;
+		}
+		case VSTFX_CC_RPN:
+			nrpn_number[ch] = -1;
+			nrpn_param[ch] = -1;
+			break;
+		case VSTFX_CC_DATA_MSB:
+			data_msb[ch] = (uint8_t)value;
+			if (nrpn_param[ch] >= 0) setValue(nrpn_param[ch], value * kScale7);
+			break;
+		case VSTFX_CC_DATA_LSB:
+			if (nrpn_param[ch] >= 0) {
+				setValue(nrpn_param[ch],
+						 ((data_msb[ch] << 7) | value) * kScale14);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+void VSTFX_MidiMap::pitchBend(int32_t ch, int32_t lsb, int32_t msb) {
+	int32_t learn = learn_target.load(std::memory_order_relaxed);
+	if (learn >= 0 && mapPitchBend(ch, learn)) {
+		learn_target.compare_exchange_strong(learn, -1);
+	}
+
+	if (bend_param[ch] >= 0) {
+		setValue(bend_param[ch], ((msb << 7) | lsb) * kScale14);
+	}
+}
+
+VSTFX_ParamMask VSTFX_MidiMap::apply(VSTFX_Params *params) {
+	for (int32_t w = 0; w < VSTFX_MIDI_FORGET_WORDS; w++) {
+		uint32_t forget = forget_mask[w].exchange(0, std::memory_order_relaxed);
+		for (; forget; forget &= forget - 1)
+			unmap(32 * w + VSTFX_LowestBit(forget));
+	}
+
+	VSTFX_ParamMask written = dirty;
+	for (int32_t i = 0; dirty.any() && i < PARAMETER_COUNT; i++) {
+		if (dirty.test(i)) params->set(i, values[i]);
+	}
+	dirty.reset();
+	return written;
+}
+
+// -------- Learning --------
+
+void VSTFX_MidiMap::learnFrom(int32_t ch, int32_t cc, int32_t param) {
+	bool mapped = false;
+
+	switch (cc_table[ch][cc].kind) {
+		case VSTFX_CC_NRPN_MSB:
+		case VSTFX_CC_NRPN_LSB:
+		case VSTFX_CC_RPN:
+			// still selecting, wait for the data
+			return;
+		case VSTFX_CC_DATA_MSB:
+		case VSTFX_CC_DATA_LSB:
+			if (nrpn_number[ch] < 0 || nrpn_number[ch] == NRPN_NULL) return;
+			mapped = mapNrpn(ch, nrpn_number[ch], param);
+			// the value must reach the freshly mapped parameter
+			nrpn_param[ch] = (int16_t)findNrpn(ch, nrpn_number[ch]);
+			break;
+		case VSTFX_CC_14BIT_LSB:
+			// second half of a pair that is already mapped
+			if (cc_table[ch][cc].param == param) return;
+			mapped = mapCC(ch, cc, param);
+			break;
+		default:
+			mapped = mapCC(ch, cc, param);
+			break;
+	}
+
+	if (mapped) learn_target.compare_exchange_strong(param, -1);
+}
+
+// -------- Table changes --------
+
+bool VSTFX_MidiMap::mapCC(int32_t ch, int32_t cc, int32_t param) {
+	if (!VSTFX_Params::IsValid(param)) return false;
+	if (ch < 0 || ch >= VSTFX_MIDI_CHANNELS || cc < 0 || cc > 127) {
+		return false;
+	}
+
+	uint8_t kind = cc_table[ch][cc].kind;
+	bool reserved = kind >= VSTFX_CC_DATA_MSB;
+	if (reserved) return false;
+
+	// 0-31 pair up with 32-63
+	bool pair = cc < MIDI_CC_LSB_OFFSET;
+	int32_t lsb = cc + MIDI_CC_LSB_OFFSET;
+
+	unmap(param);
+	if (cc_table[ch][cc].param >= 0) unmap(cc_table[ch][cc].param);
+	if (pair && cc_table[ch][lsb].param >= 0) unmap(cc_table[ch][lsb].param);
+
+	if (pair) {
+		cc_table[ch][cc] = {(int16_t)param, VSTFX_CC_14BIT_MSB};
+		cc_table[ch][lsb] = {(int16_t)param, VSTFX_CC_14BIT_LSB};
+	} else {
+		cc_table[ch][cc] = {(int16_t)param, VSTFX_CC_7BIT};
+	}
+
+	setSource(param, VSTFX_MIDI_SOURCE_CC, ch, cc);
+	return true;
+}
+
+bool VSTFX_MidiMap::mapNrpn(int32_t ch, int32_t number, int32_t param) {
+	if (!VSTFX_Params::IsValid(param)) return false;
+	if (ch < 0 || ch >= VSTFX_MIDI_CHANNELS || number < 0 ||
+		number >= NRPN_NULL) {
+		return false;
+	}
+
+	unmap(param);
+	int32_t owner = findNrpn(ch, number);
+	if (owner >= 0) unmap(owner);
+	if (nrpn_count == VSTFX_MIDI_MAX_NRPN) return false;
+
+	nrpn_table[nrpn_count++] = {(int16_t)number, (int16_t)param, ch};
+	if (nrpn_number[ch] == number) nrpn_param[ch] = (int16_t)param;
+
+	setSource(param, VSTFX_MIDI_SOURCE_NRPN, ch, number);
+	return true;
+}
+
+bool VSTFX_MidiMap::mapPitchBend(int32_t ch, int32_t param) {
+	if (!VSTFX_Params::IsValid(param)) return false;
+	if (ch < 0 || ch >= VSTFX_MIDI_CHANNELS) return false;
+
+	unmap(param);
+	if (bend_param[ch] >= 0) unmap(bend_param[ch]);
+	bend_param[ch] = (int16_t)param;
+
+	setSource(param, VSTFX_MIDI_SOURCE_PITCH_BEND, ch, 0);
+	return true;
+}
+
+void VSTFX_MidiMap::unmap(int32_t param) {
+	if (!VSTFX_Params::IsValid(param)) return;
+
+	VSTFX_MidiSource src = getSource(param);
+	int32_t ch = src.channel;
+
+	switch (src.type) {
+		case VSTFX_MIDI_SOURCE_CC:
+			cc_table[ch][src.number] = {-1, VSTFX_CC_UNMAPPED};
+			if (src.number < MIDI_CC_LSB_OFFSET) {
+				int32_t lsb = src.number + MIDI_CC_LSB_OFFSET;
+				cc_table[ch][lsb] = {-1, VSTFX_CC_UNMAPPED};
+			}
+			break;
+		case VSTFX_MIDI_SOURCE_NRPN:
+			for (int32_t i = 0; i < nrpn_count; i++) {
+				if (nrpn_table[i].param != param) continue;
+				nrpn_table[i] = nrpn_table[--nrpn_count];
+				break;
+			}
+			for (int32_t c = 0; c < VSTFX_MIDI_CHANNELS; c++) {
+				if (nrpn_param[c] == param) nrpn_param[c] = -1;
+			}
+			break;
+		case VSTFX_MIDI_SOURCE_PITCH_BEND:
+			bend_param[ch] = -1;
+			break;
+		default:
+			return;
+	}
+
+	setSource(param, VSTFX_MIDI_SOURCE_NONE, 0, 0);
+}
+
+int32_t VSTFX_MidiMap::findNrpn(int32_t ch, int32_t number) const {
+	for (int32_t i = 0; i < nrpn_count; i++) {
+		const NrpnSlot &s = nrpn_table[i];
+		if (s.channel == ch && s.number == number) return s.param;
+	}
+	return -1;
+}
+
+// -------- Sources --------
+
+// packed as type << 24 | channel << 16 | number, so readers get all three
+// from one atomic load
+void VSTFX_MidiMap::setSource(int32_t param, VSTFX_MidiSourceType type,
+							  int32_t ch, int32_t number) {
+	int32_t packed = (type << 24) | (ch << 16) | number;
+	sources[param].store(packed, std::memory_order_relaxed);
+}
+
+VSTFX_MidiSource VSTFX_MidiMap::getSource(int32_t param) const {
+	int32_t packed = sources[param].load(std::memory_order_relaxed);
+	return {(VSTFX_MidiSourceType)((packed >> 24) & 0xff),
+			(packed >> 16) & 0xff, packed & 0xffff};
+}
@@ -0,0 +1,152 @@
+#ifndef VSTFX_MIDI_MAP_H
+#define VSTFX_MIDI_MAP_H
+
+#include "core_parameters.hpp"
+#include "util/bits.hpp"
+#include "util/spsc_ring.hpp"
+#include <atomic>
+#include <cstdint>
+
+#define VSTFX_MIDI_CHANNELS 16
+#define VSTFX_MIDI_MAX_NRPN 32
+
+// editor requests to forget a mapping, 32 parameters per word
+#define VSTFX_MIDI_FORGET_WORDS ((PARAMETER_COUNT + 31) / 32)
+
+// what a controller number does, decided when it is mapped
+enum VSTFX_CCKind {
+	VSTFX_CC_UNMAPPED = 0,
+	VSTFX_CC_7BIT,		// whole value in one message, CC 64-127
+	VSTFX_CC_14BIT_MSB, // CC 0-31, also works for 7-bit only senders
+	VSTFX_CC_14BIT_LSB, // CC 32-63, refines the matching MSB
+	VSTFX_CC_DATA_MSB,	// NRPN data entry
+	VSTFX_CC_DATA_LSB,
+	VSTFX_CC_NRPN_MSB, // NRPN number select
+	VSTFX_CC_NRPN_LSB,
+	VSTFX_CC_RPN // RPN select, deselects the NRPN
+};
+
+enum VSTFX_MidiSourceType {
+	VSTFX_MIDI_SOURCE_NONE = 0,
+	VSTFX_MIDI_SOURCE_CC,
+	VSTFX_MIDI_SOURCE_NRPN,
+	VSTFX_MIDI_SOURCE_PITCH_BEND
+};
+
+// where a parameter gets its MIDI value from
+struct VSTFX_MidiSource {
+	VSTFX_MidiSourceType type;
+	int32_t channel; // 0-15
+	int32_t number;	 // CC or NRPN number, unused for pitch bend
+};
+
+/*!
+ * \brief Maps MIDI controllers, NRPNs and pitch bend to parameters.
+ *
+ * Every CC message is one lookup in a preallocated channel x controller
+ * table and one switch on the slot kind. Values are collected per
+ * parameter and handed to VSTFX_Params once per event batch, so a dense
+ * controller stream costs one parameter update per block, not per message.
+ *
+ * Each parameter has at most one source. Mapping a new one replaces the
+ * old, and a source taken from another parameter is removed from it.
+ */
+class VSTFX_MidiMap {
+public:
+	VSTFX_MidiMap();
+
+	// -------- Audio thread --------
+
+	void controlChange(int32_t channel, int32_t cc, int32_t value);
+	void pitchBend(int32_t channel, int32_t lsb, int32_t msb);
+
+	/*!
+	 * \brief Writes the values received since the last call into `params`
+	 * and carries out requests from the editor. Returns the parameters
+	 * written.
+	 */
+	VSTFX_ParamMask apply(VSTFX_Params *params);
+
+	// Changing the table directly, from the audio thread or while it is
+	// stopped. Return false for sources that cannot be mapped.
+	bool mapCC(int32_t channel, int32_t cc, int32_t param);
+	bool mapNrpn(int32_t channel, int32_t number, int32_t param);
+	bool mapPitchBend(int32_t channel, int32_t param);
+	void unmap(int32_t param);
+
+	// -------- Editor thread --------
+
+	/*!
+	 * \brief Maps the next controller, NRPN or pitch bend that moves to
+	 * `param`. Pass -1 to cancel.
+	 */
+	void learn(int32_t param) {
+		learn_target.store(param, std::memory_order_relaxed);
+	}
+
+	int32_t learning() const {
+		return learn_target.load(std::memory_order_relaxed);
+	}
+
+	/*!
+	 * \brief Removes the mapping of `param` on the next apply().
+	 */
+	void forget(int32_t param) {
+		forget_mask[param / 32].fetch_or(1u << (param % 32),
+										 std::memory_order_relaxed);
+	}
+
+	// -------- Any thread --------
+
+	VSTFX_MidiSource getSource(int32_t param) const;
+
+private:
+	struct CCSlot {
+		int16_t param;
+		uint8_t kind;
+	};
+
+	struct NrpnSlot {
+		int16_t number;
+		int16_t param;
+		int32_t channel;
+	};
+
+	void setValue(int32_t param, float value) {
+		values[param] = value;
+		dirty.set(param);
+	}
+
+	void learnFrom(int32_t channel, int32_t cc, int32_t param);
+	int32_t findNrpn(int32_t channel, int32_t number) const;
+	void setSource(int32_t param, VSTFX_MidiSourceType type, int32_t channel,
+				   int32_t number);
+
+	CCSlot cc_table[VSTFX_MIDI_CHANNELS][128];
+	int16_t bend_param[VSTFX_MIDI_CHANNELS];
+
+	NrpnSlot nrpn_table[VSTFX_MIDI_MAX_NRPN];
+	int32_t nrpn_count{0};
+
+	// running status per channel
+	uint8_t cc_msb[VSTFX_MIDI_CHANNELS][32];
+	uint8_t data_msb[VSTFX_MIDI_CHANNELS];
+	int16_t nrpn_number[VSTFX_MIDI_CHANNELS]; // -1 while an RPN is selected
+	int16_t nrpn_param[VSTFX_MIDI_CHANNELS];  // resolved on select
+
+	// received values, waiting for apply()
+	float values[PARAMETER_COUNT];
+	VSTFX_ParamMask dirty;
+
+	// feedback to the editor
+	std::atomic<int32_t> sources[PARAMETER_COUNT];
+
+	// everything above is written by the audio thread, the requests below
+	// by the editor, a line apart
+	char pad_editor[VSTFX_CACHE_LINE];
+
+	std::atomic<int32_t> learn_target{-1};
+	std::atomic<uint32_t> forget_mask[VSTFX_MIDI_FORGET_WORDS]{};
+};
+
+#endif
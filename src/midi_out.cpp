@@ -0,0 +1,46 @@
+#include "midi_out.hpp"
+
+#include <cstring>
+
+// the pool is filled in by send(), so instances that never send MIDI
+// never touch its pages
+VSTFX_MidiOut::VSTFX_MidiOut() {
+	events.numEvents = 0;
+	events.reserved = 0;
+}
+
+bool VSTFX_MidiOut::send(int32_t delta, uint8_t status, uint8_t data1,
+						 uint8_t data2) {
+	int32_t n = events.numEvents;
+	if (n == (int32_t)Vst::VstEvents::MAX_EVENTS) {
+		dropped++;
+		return false;
+	}
+
+	Vst::VstMidiEvent &ev = pool[n];
+	memset(&ev, 0, sizeof(ev));
+	ev.type = Vst::kVstMidiType;
+	ev.byteSize = sizeof(ev);
+	ev.deltaFrames = delta;
+	ev.midiData = status | (data1 << 8) | (data2 << 16);
+	events.events[n] = &ev;
+	events.numEvents = n + 1;
+	return true;
+}
+
+Vst::VstEvents *VSTFX_MidiOut::finish() {
+	int32_t n = events.numEvents;
+	if (!n) return NULL;
+
+	// hosts want frame order, senders are mostly in order already, so an
+	// insertion sort of the pointers does next to nothing
+	Vst::VstEvent **e = events.events;
+	for (int32_t i = 1; i < n; i++) {
+		Vst::VstEvent *ev = e[i];
+		int32_t j = i;
+		for (; j > 0 && e[j - 1]->deltaFrames > ev->deltaFrames; j--)
+			e[j] = e[j - 1];
+		e[j] = ev;
+	}
+	return &events;
+}
@@ -0,0 +1,44 @@
+#ifndef VSTFX_MIDI_OUT_H
+#define VSTFX_MIDI_OUT_H
+
+#include "vst.h"
+#include <cstdint>
+
+/*!
+ * \brief MIDI the plugin sends to the host, collected over a block and
+ * handed over in one audioMasterProcessEvents call.
+ *
+ * Events are written into a preallocated pool, so sending never
+ * allocates. A block can send Vst::VstEvents::MAX_EVENTS messages, more
+ * are dropped and counted.
+ *
+ * Audio thread only.
+ */
+class VSTFX_MidiOut {
+public:
+	VSTFX_MidiOut();
+
+	/*!
+	 * \brief Queues a channel message at `delta` frames into the block,
+	 * false if the block has sent all it can.
+	 */
+	bool send(int32_t delta, uint8_t status, uint8_t data1, uint8_t data2);
+
+	/*!
+	 * \brief The block's messages in frame order, NULL if there are none.
+	 * Valid until the next send().
+	 */
+	Vst::VstEvents *finish();
+
+	// starts the next block
+	void clear() { events.numEvents = 0; }
+
+	uint32_t getDropped() const { return dropped; }
+
+private:
+	Vst::VstMidiEvent pool[Vst::VstEvents::MAX_EVENTS];
+	Vst::VstEvents events;
+	uint32_t dropped{0};
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "output_layout.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+struct Pin {
+	const char *label;
+	const char *short_label;
+};
+
+static const Pin monoPins[] = {{"Out", "Out"}};
+static const Pin stereoPins[] = {{"Out L", "Out L"}, {"Out R", "Out R"}};
+static const Pin multiPins[VSTFX_MULTI_OUTPUTS] = {
+	{"Main L", "Main L"},	{"Main R", "Main R"},
+	{"Synth L", "Syn L"},	{"Synth R", "Syn R"},
+	{"Sampler L", "Smp L"}, {"Sampler R", "Smp R"}};
+
+int32_t VSTFX_OutputChannels(VSTFX_OutputLayout layout) {
+	switch (layout) {
+		case VSTFX_OUTPUT_MONO:
+			return VSTFX_OutputTraits<VSTFX_OUTPUT_MONO>::CHANNELS;
+		case VSTFX_OUTPUT_MULTI:
+			return VSTFX_OutputTraits<VSTFX_OUTPUT_MULTI>::CHANNELS;
+		default:
+			return VSTFX_OutputTraits<VSTFX_OUTPUT_STEREO>::CHANNELS;
+	}
+}
+
+bool VSTFX_OutputLayoutFor(int32_t channels, VSTFX_OutputLayout *layout) {
+	for (int32_t l = 0; l < VSTFX_OUTPUT_LAYOUT_COUNT; l++) {
+		if (VSTFX_OutputChannels((VSTFX_OutputLayout)l) == channels) {
+			*layout = (VSTFX_OutputLayout)l;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool VSTFX_GetOutputProperties(VSTFX_OutputLayout layout, int32_t index,
+							   Vst::VstPinProperties *props) {
+	if (index < 0 || index >= VSTFX_OutputChannels(layout)) return false;
+
+	const Pin *pins = layout == VSTFX_OUTPUT_MONO	 ? monoPins
+					  : layout == VSTFX_OUTPUT_MULTI ? multiPins
+													 : stereoPins;
+	bool stereo = layout != VSTFX_OUTPUT_MONO;
+
+	memset(props, 0, sizeof(*props));
+	snprintf(props->label, Vst::kVstMaxLabelLen, "%s", pins[index].label);
+	snprintf(props->shortLabel, Vst::kVstMaxShortLabelLen, "%s",
+			 pins[index].short_label);
+
+	// hosts pair an output marked stereo with the one after it
+	int32_t flags = Vst::kVstPinIsActive;
+	if (stereo && index % 2 == 0) flags |= Vst::kVstPinIsStereo;
+	props->flags = (Vst::VstPinPropertiesFlags)flags;
+	props->arragementType =
+		stereo ? Vst::kSpeakerArrStereo : Vst::kSpeakerArrMono;
+	return true;
+}
@@ -0,0 +1,44 @@
+#ifndef VSTFX_OUTPUT_LAYOUT_H
+#define VSTFX_OUTPUT_LAYOUT_H
+
+#include "vst.h"
+#include <cstdint>
+
+enum VSTFX_OutputLayout {
+	VSTFX_OUTPUT_MONO = 0, // the mix summed to one channel
+	VSTFX_OUTPUT_STEREO,
+	VSTFX_OUTPUT_MULTI, // the mix, then each layer dry on a pair of its own
+
+	VSTFX_OUTPUT_LAYOUT_COUNT
+};
+
+// outputs of the multi-out layout: mix, synth voices, sampler
+#define VSTFX_MULTI_OUTPUTS 6
+
+/*!
+ * \brief What a layout looks like at compile time, so each one renders
+ * through a loop of its own.
+ */
+template <VSTFX_OutputLayout L> struct VSTFX_OutputTraits {
+	// channels the mix is written to
+	static constexpr int32_t MIX = L == VSTFX_OUTPUT_MONO ? 1 : 2;
+	// whether synth and sampler also go out separately
+	static constexpr bool LAYERS = L == VSTFX_OUTPUT_MULTI;
+	static constexpr int32_t CHANNELS = LAYERS ? VSTFX_MULTI_OUTPUTS : MIX;
+};
+
+int32_t VSTFX_OutputChannels(VSTFX_OutputLayout layout);
+
+/*!
+ * \brief The layout for `channels` outputs, false if there is none.
+ */
+bool VSTFX_OutputLayoutFor(int32_t channels, VSTFX_OutputLayout *layout);
+
+/*!
+ * \brief Label, pairing and speaker arrangement of an output, for
+ * effGetOutputProperties. False past the last output.
+ */
+bool VSTFX_GetOutputProperties(VSTFX_OutputLayout layout, int32_t index,
+							   Vst::VstPinProperties *props);
+
+#endif
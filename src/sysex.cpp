@@ -0,0 +1,181 @@
+#include "sysex.hpp"
+#include "midi.hpp"
+#include <cstring>
+
+static const uint8_t sysexHeader[] = {MIDI_SYSEX, VSTFX_SYSEX_ID};
+
+#define SYSEX_END 0xf7
+
+void VSTFX_Patch::apply(VSTFX_Params *params) const {
+	for (int32_t i = 0; i < PARAMETER_COUNT; i++) {
+		if (mask.test(i)) params->set(i, values[i]);
+	}
+}
+
+VSTFX_SysEx::VSTFX_SysEx()
+	: idle_bank(new VSTFX_PatchBank()), message(VSTFX_SYSEX_ARENA) {}
+
+VSTFX_SysEx::~VSTFX_SysEx() {
+	delete pending_patch.load();
+	delete retired_patch.load();
+	delete pending_bank.load();
+	delete retired_bank.load();
+	delete bank;
+	delete idle_bank;
+}
+
+// -------- Audio thread --------
+
+bool VSTFX_SysEx::receive(const uint8_t *data, int32_t size) {
+	uint8_t length[4] = {(uint8_t)size, (uint8_t)(size >> 8),
+						 (uint8_t)(size >> 16), (uint8_t)(size >> 24)};
+
+	// the idle thread only ever frees space, so this cannot go stale
+	size_t space = arena.capacity() - arena.size();
+	if (!data || size <= 0 || sizeof(length) + size > space) {
+		dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	arena.push(length, sizeof(length));
+	arena.push(data, size);
+	return true;
+}
+
+void VSTFX_SysEx::apply(VSTFX_Params *params) {
+	// a swapped out one waits until the idle thread has freed the last
+	if (!retired_patch.load(std::memory_order_acquire)) {
+		VSTFX_Patch *patch =
+			pending_patch.exchange(NULL, std::memory_order_acq_rel);
+		if (patch) {
+			patch->apply(params);
+			retired_patch.store(patch, std::memory_order_release);
+		}
+	}
+
+	if (!retired_bank.load(std::memory_order_acquire)) {
+		VSTFX_PatchBank *next =
+			pending_bank.exchange(NULL, std::memory_order_acq_rel);
+		if (next) {
+			VSTFX_PatchBank *old = bank;
+			bank = next;
+			if (old) retired_bank.store(old, std::memory_order_release);
+		}
+	}
+}
+
+void VSTFX_SysEx::programChange(int32_t program, VSTFX_Params *params) {
+	if (!bank || program < 0 || program >= VSTFX_PROGRAMS) return;
+	bank->programs[program].apply(params);
+}
+
+// -------- Idle thread --------
+
+int32_t VSTFX_SysEx::idle() {
+	delete retired_patch.exchange(NULL, std::memory_order_acq_rel);
+	delete retired_bank.exchange(NULL, std::memory_order_acq_rel);
+
+	int32_t handed = 0;
+	uint8_t length[4];
+	while (arena.peek(length, sizeof(length)) == sizeof(length)) {
+		int32_t size = length[0] | (length[1] << 8) | (length[2] << 16) |
+					   (length[3] << 24);
+		// the audio thread may still be copying the message in
+		if (arena.size() < sizeof(length) + size) break;
+
+		arena.pop(length, sizeof(length));
+		arena.pop(message.data(), size);
+
+		if (parse(message.data(), size)) {
+			handed++;
+		} else {
+			rejected.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return handed;
+}
+
+bool VSTFX_SysEx::parse(const uint8_t *msg, int32_t size) {
+	int32_t header = (int32_t)sizeof(sysexHeader);
+	// header, command, checksum and end
+	if (size < header + 3) return false;
+	if (memcmp(msg, sysexHeader, header) || msg[size - 1] != SYSEX_END)
+		return false;
+
+	const uint8_t *body = msg + header;
+	int32_t body_size = size - header - 1; // command up to the checksum
+
+	uint32_t sum = 0;
+	for (int32_t i = 0; i < body_size; i++) {
+		if (body[i] & 0x80) return false;
+		sum += body[i];
+	}
+	if (sum & 0x7f) return false;
+
+	const uint8_t *p = body + 1;
+	int32_t left = body_size - 2; // without command and checksum
+
+	if (body[0] == VSTFX_SYSEX_PATCH) {
+		VSTFX_Patch *patch = new VSTFX_Patch();
+		if (ParsePatch(p, left, patch) != left) {
+			delete patch;
+			return false;
+		}
+		// one the audio thread has not picked up yet is simply replaced
+		delete pending_patch.exchange(patch, std::memory_order_acq_rel);
+		return true;
+	}
+
+	if (body[0] == VSTFX_SYSEX_BANK) {
+		if (left < 2) return false;
+		int32_t first = p[0], count = p[1] - p[0] + 1;
+		if (count < 1) return false;
+		p += 2;
+		left -= 2;
+
+		// programs the dump leaves out keep what earlier dumps set
+		VSTFX_PatchBank *next = new VSTFX_PatchBank(*idle_bank);
+		for (int32_t i = 0; i < count; i++) {
+			int32_t used = ParsePatch(p, left, &next->programs[first + i]);
+			if (used < 0) {
+				delete next;
+				return false;
+			}
+			p += used;
+			left -= used;
+		}
+		if (left) {
+			delete next;
+			return false;
+		}
+
+		*idle_bank = *next;
+		delete pending_bank.exchange(next, std::memory_order_acq_rel);
+		return true;
+	}
+
+	return false;
+}
+
+// bytes used, -1 if the patch is malformed
+int32_t VSTFX_SysEx::ParsePatch(const uint8_t *p, int32_t size,
+								VSTFX_Patch *patch) {
+	if (size < VSTFX_PATCH_NAME + 1) return -1;
+
+	memcpy(patch->name, p, VSTFX_PATCH_NAME);
+	patch->name[VSTFX_PATCH_NAME] = '\0';
+	patch->mask.reset();
+
+	int32_t count = p[VSTFX_PATCH_NAME];
+	int32_t used = VSTFX_PATCH_NAME + 1 + 3 * count;
+	if (used > size) return -1;
+
+	const uint8_t *v = p + VSTFX_PATCH_NAME + 1;
+	for (int32_t i = 0; i < count; i++, v += 3) {
+		int32_t index = v[0];
+		if (!VSTFX_Params::IsValid(index)) continue; // from a newer version
+		patch->values[index] = ((v[1] << 7) | v[2]) / 16383.0f;
+		patch->mask.set(index);
+	}
+	return used;
+}
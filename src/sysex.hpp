@@ -0,0 +1,116 @@
+#ifndef VSTFX_SYSEX_H
+#define VSTFX_SYSEX_H
+
+#include "core_parameters.hpp"
+#include "util/spsc_ring.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// received SysEx waits here for the idle thread, length prefixed
+#define VSTFX_SYSEX_ARENA 65536
+
+#define VSTFX_PROGRAMS 128
+#define VSTFX_PATCH_NAME 16
+
+// non-commercial manufacturer ID, then "VF"
+#define VSTFX_SYSEX_ID 0x7d, 0x56, 0x46
+
+enum VSTFX_SysExCommand {
+	VSTFX_SYSEX_PATCH = 0x01, // one patch, applied right away
+	VSTFX_SYSEX_BANK = 0x02	  // programs, picked by program change
+};
+
+/*!
+ * \brief Parameter values, all or some of them.
+ */
+struct VSTFX_Patch {
+	char name[VSTFX_PATCH_NAME + 1];
+	VSTFX_ParamMask mask; // parameters the patch sets
+	float values[PARAMETER_COUNT];
+
+	void apply(VSTFX_Params *params) const;
+};
+
+struct VSTFX_PatchBank {
+	VSTFX_Patch programs[VSTFX_PROGRAMS]; // empty ones have no mask
+};
+
+/*!
+ * \brief Patch and bank dumps over SysEx.
+ *
+ *     F0 7D 56 46 <command> <payload> <checksum> F7
+ *
+ *     patch:  <name, 16 bytes> <count> count x <param> <value MSB> <LSB>
+ *     bank:   <first program> <last program> a patch for each
+ *
+ * Values are 14-bit normalized, the checksum makes the command, payload
+ * and checksum bytes add up to a multiple of 128.
+ *
+ * The audio thread only copies messages into a preallocated arena. The
+ * idle thread parses them and hands finished patches and banks back
+ * through atomic pointers, which the audio thread swaps in. Whatever it
+ * swaps out goes back the same way to be freed on the idle thread, so
+ * neither allocation nor a lock ever happens inside effProcessEvents.
+ */
+class VSTFX_SysEx {
+public:
+	VSTFX_SysEx();
+	~VSTFX_SysEx();
+
+	// -------- Audio thread --------
+
+	/*!
+	 * \brief Queues a complete message, false if the arena is full.
+	 */
+	bool receive(const uint8_t *data, int32_t size);
+
+	/*!
+	 * \brief Applies a patch the idle thread has parsed, and takes over a
+	 * new bank.
+	 */
+	void apply(VSTFX_Params *params);
+
+	void programChange(int32_t program, VSTFX_Params *params);
+
+	// -------- Idle thread --------
+
+	/*!
+	 * \brief Parses everything received so far, returns the number of
+	 * patches and banks handed to the audio thread.
+	 */
+	int32_t idle();
+
+	// -------- Any thread --------
+
+	uint32_t getDropped() const {
+		return dropped.load(std::memory_order_relaxed);
+	}
+	uint32_t getRejected() const {
+		return rejected.load(std::memory_order_relaxed);
+	}
+
+private:
+	bool parse(const uint8_t *msg, int32_t size);
+	static int32_t ParsePatch(const uint8_t *p, int32_t size,
+							  VSTFX_Patch *patch);
+
+	VSTFX_SpscRing<uint8_t, VSTFX_SYSEX_ARENA> arena;
+	std::atomic<uint32_t> dropped{0};
+
+	// idle -> audio, and back to be freed
+	std::atomic<VSTFX_Patch *> pending_patch{NULL}, retired_patch{NULL};
+	std::atomic<VSTFX_PatchBank *> pending_bank{NULL}, retired_bank{NULL};
+
+	// audio thread's
+	VSTFX_PatchBank *bank{NULL};
+	char pad_idle[VSTFX_CACHE_LINE];
+
+	// idle thread's, a line apart: the last bank handed over, and parse
+	// scratch
+	VSTFX_PatchBank *idle_bank;
+	std::vector<uint8_t> message;
+	std::atomic<uint32_t> rejected{0};
+};
+
+#endif
@@ -0,0 +1,3 @@
+#include "arena.hpp"
+
+bool VSTFX_Arena::packed = false;
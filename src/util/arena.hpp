@@ -0,0 +1,95 @@
+#ifndef VSTFX_ARENA_H
+#define VSTFX_ARENA_H
+
+#include "spsc_ring.hpp"
+#include "zero_pages.hpp"
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*!
+ * \brief One block of memory holding an instance's long-lived objects,
+ * each starting on a cache line of its own.
+ *
+ * The block is sized once, up front, from the objects it is going to
+ * hold, so nothing moves and nothing is allocated afterwards. Objects
+ * written by different threads never share a cache line, and the ones a
+ * thread uses together sit next to each other. They are destroyed with
+ * the arena, newest first.
+ *
+ * If the OS refuses the block, the arena stays empty and create()
+ * returns NULL.
+ */
+class VSTFX_Arena {
+public:
+	// bytes an object of `size` bytes takes up in the arena
+	static constexpr size_t Lines(size_t size) {
+		return (size + VSTFX_CACHE_LINE - 1) / VSTFX_CACHE_LINE *
+			   VSTFX_CACHE_LINE;
+	}
+
+	explicit VSTFX_Arena(size_t capacity) { pages.allocate(capacity); }
+
+	~VSTFX_Arena() {
+		for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+			it->destroy(it->object);
+	}
+
+	VSTFX_Arena(const VSTFX_Arena &) = delete;
+	VSTFX_Arena &operator=(const VSTFX_Arena &) = delete;
+
+	/*!
+	 * \brief Constructs a T on the next free cache line, NULL if the
+	 * capacity has no room for it, see Lines().
+	 */
+	template <typename T, typename... Args> T *create(Args &&...args) {
+		void *p = reserve<T>();
+		return p ? track(new (p) T(std::forward<Args>(args)...)) : NULL;
+	}
+
+	// default-initialized, members without an initializer stay zero
+	// without value-initialization writing to every page of a large T
+	template <typename T> T *create() {
+		void *p = reserve<T>();
+		return p ? track(new (p) T) : NULL;
+	}
+
+	size_t size() const { return used; }
+
+	// on, arenas created afterwards place objects back to back like plain
+	// members, sharing lines, for benchmarks
+	static void SetPacked(bool on) { packed = on; }
+
+private:
+	template <typename T> void *reserve() {
+		static_assert(alignof(T) <= VSTFX_CACHE_LINE, "over-aligned type");
+		size_t start = used, end = used + Lines(sizeof(T));
+		if (packing) {
+			start = (used + alignof(T) - 1) / alignof(T) * alignof(T);
+			end = start + sizeof(T);
+		}
+		if (end > pages.size()) return NULL;
+		used = end;
+		return (char *)pages.data() + start;
+	}
+
+	template <typename T> T *track(T *object) {
+		objects.push_back({object, [](void *o) { ((T *)o)->~T(); }});
+		return object;
+	}
+
+	struct Object {
+		void *object;
+		void (*destroy)(void *);
+	};
+
+	VSTFX_ZeroPages pages; // page aligned, so every line is too
+	size_t used{0};
+	std::vector<Object> objects;
+	bool packing{packed};
+
+	static bool packed;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#include "asset_cache.hpp"
+
+bool VSTFX_AssetCache::sharing = true;
+
+// function statics, so instances created during static initialization
+// still find them constructed
+std::mutex &VSTFX_AssetCache::Mutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+VSTFX_AssetCache::AssetMap &VSTFX_AssetCache::Assets() {
+	static AssetMap assets;
+	return assets;
+}
+
+void VSTFX_AssetCache::Sweep() {
+	AssetMap &assets = Assets();
+	for (auto it = assets.begin(); it != assets.end();) {
+		if (it->second.expired()) {
+			it = assets.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+size_t VSTFX_AssetCache::Count() {
+	std::lock_guard<std::mutex> lock(Mutex());
+	Sweep();
+	return Assets().size();
+}
+
+void VSTFX_AssetCache::SetSharing(bool on) {
+	std::lock_guard<std::mutex> lock(Mutex());
+	sharing = on;
+}
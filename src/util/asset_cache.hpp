@@ -0,0 +1,57 @@
+#ifndef VSTFX_ASSET_CACHE_H
+#define VSTFX_ASSET_CACHE_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*!
+ * \brief Immutable data shared by every instance in the module: tables,
+ * decoded images and the like.
+ *
+ * An asset is built by the first instance that asks for it and freed with
+ * the last one that holds it. Lookups take a lock, so they belong in
+ * constructors and setup calls, never on the audio thread.
+ */
+class VSTFX_AssetCache {
+public:
+	/*!
+	 * \brief The asset under `key`, built with `build()`, which returns a
+	 * new T, if no instance holds it. Keys name the kind of asset and what
+	 * it was built for, e.g. "filter.cutoff/48000".
+	 */
+	template <typename T, typename Build>
+	static std::shared_ptr<const T> Get(const std::string &key, Build build) {
+		std::lock_guard<std::mutex> lock(Mutex());
+		std::weak_ptr<const void> &slot = Assets()[key];
+
+		std::shared_ptr<const void> found = slot.lock();
+		if (found && sharing) return std::static_pointer_cast<const T>(found);
+
+		std::shared_ptr<const T> asset(build());
+		slot = asset;
+		Sweep();
+		return asset;
+	}
+
+	// assets some instance still holds
+	static size_t Count();
+
+	// off, every Get() builds a copy of its own, for benchmarks
+	static void SetSharing(bool on);
+
+private:
+	typedef std::map<std::string, std::weak_ptr<const void>> AssetMap;
+
+	static std::mutex &Mutex();
+	static AssetMap &Assets();
+
+	// drops the entries of assets nobody holds any more
+	static void Sweep();
+
+	static bool sharing;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef VSTFX_BITS_H
+#define VSTFX_BITS_H
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// index of the lowest set bit, `x` must not be 0
+inline int32_t VSTFX_LowestBit(uint32_t x) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, x);
+	return (int32_t)index;
+#else
+	return __builtin_ctz(x);
+#endif
+}
+
+#endif
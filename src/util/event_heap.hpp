@@ -0,0 +1,96 @@
+#ifndef VSTFX_EVENT_HEAP_H
+#define VSTFX_EVENT_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+/*!
+ * \brief Bounded min-heap of items keyed by absolute sample time, for
+ * events due after the block they were scheduled in.
+ *
+ * Push and pop are O(log n) and never allocate, the storage is part of
+ * the heap. Items due at the same time come out in the order they went
+ * in. When the heap is full, push() refuses the item.
+ */
+template <typename T, size_t N> class VSTFX_EventHeap {
+public:
+	// false if the heap is full
+	bool push(int64_t time, const T &item) {
+		if (count == N) return false;
+
+		// sift the hole up from the end
+		Entry e{time, seq++, item};
+		size_t i = count++;
+		while (i > 0) {
+			size_t parent = (i - 1) / 2;
+			if (!Before(e, at(parent))) break;
+			put(i, at(parent));
+			i = parent;
+		}
+		put(i, e);
+		return true;
+	}
+
+	/*!
+	 * \brief Takes the earliest item if it is due at or before `now`.
+	 */
+	bool pop(int64_t now, T *item) {
+		if (!count || at(0).time > now) return false;
+		*item = at(0).item;
+
+		// sift the last entry down from the root
+		Entry last = at(--count);
+		size_t i = 0;
+		for (;;) {
+			size_t child = 2 * i + 1;
+			if (child >= count) break;
+			if (child + 1 < count && Before(at(child + 1), at(child)))
+				child++;
+			if (!Before(at(child), last)) break;
+			put(i, at(child));
+			i = child;
+		}
+		put(i, last);
+		return true;
+	}
+
+	// time of the earliest item, INT64_MAX when empty
+	int64_t next() const { return count ? at(0).time : INT64_MAX; }
+
+	void clear() { count = 0; }
+	bool empty() const { return count == 0; }
+	size_t size() const { return count; }
+	static constexpr size_t capacity() { return N; }
+
+private:
+	struct Entry {
+		int64_t time;
+		uint32_t seq; // insertion order, breaks ties
+		T item;
+	};
+	static_assert(std::is_trivially_copyable<Entry>::value,
+				  "entries are copied into raw storage");
+
+	const Entry &at(size_t i) const {
+		return *reinterpret_cast<const Entry *>(&entries[i]);
+	}
+	void put(size_t i, const Entry &e) { new (&entries[i]) Entry(e); }
+
+	// wraps around safely, pending items are never 2^31 pushes apart
+	static bool Before(const Entry &a, const Entry &b) {
+		if (a.time != b.time) return a.time < b.time;
+		return (int32_t)(a.seq - b.seq) < 0;
+	}
+
+	size_t count{0};
+	uint32_t seq{0};
+
+	// raw storage, even for items with initializers, so pages of a large
+	// heap are only touched once it grows into them
+	typename std::aligned_storage<sizeof(Entry), alignof(Entry)>::type
+		entries[N];
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool VSTFX_MappedFile::open(const char *path) {
+	close();
+
+	HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+						   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (f == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(f, &size) || size.QuadPart == 0) {
+		CloseHandle(f);
+		return false;
+	}
+
+	HANDLE m = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m) {
+		CloseHandle(f);
+		return false;
+	}
+
+	void *view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(m);
+		CloseHandle(f);
+		return false;
+	}
+
+	file = f;
+	mapping = m;
+	bytes = (const uint8_t *)view;
+	length = (size_t)size.QuadPart;
+	return true;
+}
+
+void VSTFX_MappedFile::close() {
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mapping) CloseHandle((HANDLE)mapping);
+	if (file) CloseHandle((HANDLE)file);
+	bytes = NULL;
+	length = 0;
+	file = mapping = NULL;
+}
+
+#else
+
+bool VSTFX_MappedFile::open(const char *path) {
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps the file alive on its own
+	::close(fd);
+	if (view == MAP_FAILED) return false;
+
+	// samples are streamed front to back
+	madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	bytes = (const uint8_t *)view;
+	length = (size_t)st.st_size;
+	return true;
+}
+
+void VSTFX_MappedFile::close() {
+	if (bytes) munmap((void *)bytes, length);
+	bytes = NULL;
+	length = 0;
+}
+
+#endif
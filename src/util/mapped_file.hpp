@@ -0,0 +1,37 @@
+#ifndef VSTFX_MAPPED_FILE_H
+#define VSTFX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief A read-only file mapped into the address space.
+ *
+ * Nothing is read at open(), pages are brought in by the OS on first
+ * access, so whoever touches the data first pays for the disk.
+ */
+class VSTFX_MappedFile {
+public:
+	VSTFX_MappedFile() {}
+	~VSTFX_MappedFile() { close(); }
+
+	VSTFX_MappedFile(const VSTFX_MappedFile &) = delete;
+	VSTFX_MappedFile &operator=(const VSTFX_MappedFile &) = delete;
+
+	bool open(const char *path);
+	void close();
+
+	const uint8_t *data() const { return bytes; }
+	size_t size() const { return length; }
+	bool isOpen() const { return bytes != NULL; }
+
+private:
+	const uint8_t *bytes{NULL};
+	size_t length{0};
+
+#ifdef _WIN32
+	void *file{NULL}, *mapping{NULL}; // HANDLEs
+#endif
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef VSTFX_SIMD_H
+#define VSTFX_SIMD_H
+
+// SSE is optional on the x86 MinGW target, everything using it keeps a
+// scalar fallback
+#if defined(__SSE__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define VSTFX_HAS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+/*!
+ * \brief Four floats processed together, one SSE register where available.
+ *
+ * Lets per-lane DSP (four voices side by side) be written once for both
+ * the SSE and the scalar build.
+ */
+struct VSTFX_Float4 {
+#ifdef VSTFX_HAS_SSE
+	__m128 v;
+
+	VSTFX_Float4() {}
+	VSTFX_Float4(__m128 x) : v(x) {}
+	VSTFX_Float4(float x) : v(_mm_set1_ps(x)) {}
+
+	static VSTFX_Float4 load(const float *p) { return _mm_loadu_ps(p); }
+	void store(float *p) const { _mm_storeu_ps(p, v); }
+
+	friend VSTFX_Float4 operator+(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_add_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 operator-(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_sub_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 operator*(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_mul_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 operator/(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_div_ps(a.v, b.v);
+	}
+#else
+	float v[4];
+
+	VSTFX_Float4() {}
+	VSTFX_Float4(float x) { v[0] = v[1] = v[2] = v[3] = x; }
+
+	static VSTFX_Float4 load(const float *p) {
+		VSTFX_Float4 r;
+		for (int i = 0; i < 4; i++)
+			r.v[i] = p[i];
+		return r;
+	}
+	void store(float *p) const {
+		for (int i = 0; i < 4; i++)
+			p[i] = v[i];
+	}
+
+#define VSTFX_FLOAT4_OP(op)                                          \
+	friend VSTFX_Float4 operator op(VSTFX_Float4 a, VSTFX_Float4 b) { \
+		for (int i = 0; i < 4; i++)                                  \
+			a.v[i] = a.v[i] op b.v[i];                               \
+		return a;                                                    \
+	}
+	VSTFX_FLOAT4_OP(+)
+	VSTFX_FLOAT4_OP(-)
+	VSTFX_FLOAT4_OP(*)
+	VSTFX_FLOAT4_OP(/)
+#undef VSTFX_FLOAT4_OP
+#endif
+
+	VSTFX_Float4 &operator+=(VSTFX_Float4 b) { return *this = *this + b; }
+
+	// -------- Comparisons and masks --------
+	//
+	// Masks come from the comparisons and are only meant for And() and
+	// Select(): all bits set per true lane with SSE, 1.0 in the scalar build.
+
+#ifdef VSTFX_HAS_SSE
+	friend VSTFX_Float4 Less(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_cmplt_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 GreaterEq(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_cmpge_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 And(VSTFX_Float4 mask, VSTFX_Float4 a) {
+		return _mm_and_ps(mask.v, a.v);
+	}
+	friend VSTFX_Float4 Select(VSTFX_Float4 mask, VSTFX_Float4 a,
+							   VSTFX_Float4 b) {
+		return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+	}
+	friend VSTFX_Float4 Min(VSTFX_Float4 a, VSTFX_Float4 b) {
+		return _mm_min_ps(a.v, b.v);
+	}
+	friend VSTFX_Float4 Abs(VSTFX_Float4 a) {
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v);
+	}
+	// magnitude of `a` with the sign of `b`
+	friend VSTFX_Float4 CopySign(VSTFX_Float4 a, VSTFX_Float4 b) {
+		__m128 sign = _mm_set1_ps(-0.0f);
+		return _mm_or_ps(_mm_andnot_ps(sign, a.v), _mm_and_ps(sign, b.v));
+	}
+
+	float sum() const {
+		__m128 x = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+		return _mm_cvtss_f32(x);
+	}
+#else
+#define VSTFX_FLOAT4_MAP(expr)    \
+	VSTFX_Float4 r;               \
+	for (int i = 0; i < 4; i++) \
+		r.v[i] = (expr);          \
+	return r;
+
+	friend VSTFX_Float4 Less(VSTFX_Float4 a, VSTFX_Float4 b) {
+		VSTFX_FLOAT4_MAP(a.v[i] < b.v[i] ? 1.0f : 0.0f)
+	}
+	friend VSTFX_Float4 GreaterEq(VSTFX_Float4 a, VSTFX_Float4 b) {
+		VSTFX_FLOAT4_MAP(a.v[i] >= b.v[i] ? 1.0f : 0.0f)
+	}
+	friend VSTFX_Float4 And(VSTFX_Float4 mask, VSTFX_Float4 a) {
+		VSTFX_FLOAT4_MAP(mask.v[i] != 0.0f ? a.v[i] : 0.0f)
+	}
+	friend VSTFX_Float4 Select(VSTFX_Float4 mask, VSTFX_Float4 a,
+							   VSTFX_Float4 b) {
+		VSTFX_FLOAT4_MAP(mask.v[i] != 0.0f ? a.v[i] : b.v[i])
+	}
+	friend VSTFX_Float4 Min(VSTFX_Float4 a, VSTFX_Float4 b) {
+		VSTFX_FLOAT4_MAP(a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+	}
+	friend VSTFX_Float4 Abs(VSTFX_Float4 a) {
+		VSTFX_FLOAT4_MAP(a.v[i] < 0.0f ? -a.v[i] : a.v[i])
+	}
+	friend VSTFX_Float4 CopySign(VSTFX_Float4 a, VSTFX_Float4 b) {
+		VSTFX_FLOAT4_MAP((a.v[i] < 0.0f) != (b.v[i] < 0.0f) ? -a.v[i] : a.v[i])
+	}
+#undef VSTFX_FLOAT4_MAP
+
+	float sum() const { return v[0] + v[1] + v[2] + v[3]; }
+#endif
+};
+
+#endif
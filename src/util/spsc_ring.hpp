@@ -0,0 +1,91 @@
+#ifndef VSTFX_SPSC_RING_H
+#define VSTFX_SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+// keeps fields written by different threads on separate cache lines
+#define VSTFX_CACHE_LINE 64
+
+/*!
+ * \brief Wait-free single-producer single-consumer ring buffer.
+ *
+ * The producer only writes `head` and the consumer only writes `tail`, so
+ * neither side ever blocks or retries. Capacity must be a power of two.
+ * When the ring is full, push() drops whatever does not fit.
+ */
+template <typename T, size_t N> class VSTFX_SpscRing {
+	static_assert(N && !(N & (N - 1)), "capacity must be a power of two");
+
+public:
+	// -------- Producer side --------
+
+	size_t push(const T *items, size_t count) {
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_acquire);
+		size_t space = N - (h - t);
+		if (count > space) count = space;
+
+		// at most two contiguous runs, split where the ring wraps
+		size_t start = h & (N - 1);
+		size_t first = count < N - start ? count : N - start;
+		std::copy(items, items + first, buffer + start);
+		std::copy(items + first, items + count, buffer);
+
+		head.store(h + count, std::memory_order_release);
+		return count;
+	}
+
+	bool push(const T &item) { return push(&item, 1) == 1; }
+
+	// -------- Consumer side --------
+
+	size_t pop(T *items, size_t count) {
+		count = peek(items, count);
+		size_t t = tail.load(std::memory_order_relaxed);
+		tail.store(t + count, std::memory_order_release);
+		return count;
+	}
+
+	// copies like pop(), but leaves the items in the ring
+	size_t peek(T *items, size_t count) const {
+		size_t t = tail.load(std::memory_order_relaxed);
+		size_t h = head.load(std::memory_order_acquire);
+		size_t avail = h - t;
+		if (count > avail) count = avail;
+
+		size_t start = t & (N - 1);
+		size_t first = count < N - start ? count : N - start;
+		std::copy(buffer + start, buffer + start + first, items);
+		std::copy(buffer, buffer + count - first, items + first);
+		return count;
+	}
+
+	bool pop(T &item) { return pop(&item, 1) == 1; }
+
+	// drops everything pushed so far, without copying it out
+	void discard() {
+		tail.store(head.load(std::memory_order_acquire),
+				   std::memory_order_release);
+	}
+
+	// -------- Either side --------
+
+	size_t size() const {
+		return head.load(std::memory_order_acquire) -
+			   tail.load(std::memory_order_acquire);
+	}
+
+	static constexpr size_t capacity() { return N; }
+
+private:
+	std::atomic<size_t> head{0};
+	char pad_head[VSTFX_CACHE_LINE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail{0};
+	char pad_tail[VSTFX_CACHE_LINE - sizeof(std::atomic<size_t>)];
+
+	T buffer[N];
+};
+
+#endif
@@ -0,0 +1,258 @@
+#include "trace.hpp"
+
+#include "spsc_ring.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// spans a thread can record before the writer gets to them
+#define TRACE_RING_SIZE 4096
+
+// threads that can record, each takes a ring for good
+#define TRACE_MAX_THREADS 16
+
+// how often the writer drains the rings
+#define TRACE_FLUSH_MS 20
+
+std::atomic<bool> VSTFX_Trace::enabled{false};
+
+namespace {
+
+struct ThreadRing {
+	VSTFX_SpscRing<VSTFX_TraceEvent, TRACE_RING_SIZE> ring;
+	std::atomic<uint32_t> dropped{0};
+	int32_t tid;
+	const char *name; // the category of the thread's first span
+	bool named{false}; // whether the file has its name yet
+
+	// set once tid and name are, the writer skips the ring until then
+	std::atomic<bool> ready{false};
+};
+
+struct Writer {
+	// allocated by the first Start() and kept, threads keep a pointer to
+	// theirs; `claimed` counts past the end once every ring is taken
+	std::atomic<ThreadRing *> rings{NULL};
+	std::atomic<int32_t> claimed{0};
+
+	// held for the whole of Start(), Stop() and the instance count, so
+	// neither ever sees the other halfway
+	std::mutex control;
+
+	// the writer thread's wakeups and `running`
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::thread thread;
+	bool running{false};
+	int32_t users{0};
+
+	FILE *file{NULL};
+	bool first{true};
+	int64_t origin{0};
+
+	// where the last trace ended, the next one into the same file picks
+	// up there instead of starting over
+	std::string path;
+	long end{-1};
+};
+
+// a function static, so instances created during static initialization
+// still find it constructed
+Writer &State() {
+	static Writer writer;
+	return writer;
+}
+
+// a ring of the pool for the calling thread, NULL once all are taken
+ThreadRing *Claim(const char *name) {
+	Writer &w = State();
+	ThreadRing *rings = w.rings.load(std::memory_order_acquire);
+	if (!rings || w.claimed.load(std::memory_order_relaxed) >=
+					  TRACE_MAX_THREADS)
+		return NULL;
+
+	int32_t i = w.claimed.fetch_add(1, std::memory_order_relaxed);
+	if (i >= TRACE_MAX_THREADS) return NULL;
+
+	ThreadRing *ring = &rings[i];
+	ring->tid = i + 1;
+	ring->name = name;
+	ring->ready.store(true, std::memory_order_release);
+	return ring;
+}
+
+// the rings the writer may look at
+int32_t Claimed(Writer &w) {
+	int32_t n = w.claimed.load(std::memory_order_relaxed);
+	return n < TRACE_MAX_THREADS ? n : TRACE_MAX_THREADS;
+}
+
+// -------- File --------
+
+void Separate(Writer &w) {
+	fputs(w.first ? "\n" : ",\n", w.file);
+	w.first = false;
+}
+
+void WriteEvent(Writer &w, int32_t tid, const VSTFX_TraceEvent &e) {
+	Separate(w);
+	fprintf(w.file,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+			"\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+			e.name, e.cat, (int)tid, (e.start - w.origin) / 1000.0,
+			e.duration / 1000.0);
+	if (e.arg_name) {
+		fprintf(w.file, ",\"args\":{\"%s\":%lld}", e.arg_name,
+				(long long)e.arg);
+	}
+	fputs("}", w.file);
+}
+
+// everything recorded so far, called by the writer thread only
+void Drain(Writer &w, bool last) {
+	ThreadRing *rings = w.rings.load(std::memory_order_relaxed);
+	int32_t count = Claimed(w);
+
+	VSTFX_TraceEvent events[256];
+	for (int32_t i = 0; i < count; i++) {
+		ThreadRing *r = &rings[i];
+		if (!r->ready.load(std::memory_order_acquire)) continue;
+
+		size_t n = r->ring.size();
+		if (n && !r->named) {
+			Separate(w);
+			fprintf(w.file,
+					"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+					"\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+					(int)r->tid, r->name);
+			r->named = true;
+		}
+		while ((n = r->ring.pop(events, 256)) > 0) {
+			for (size_t i = 0; i < n; i++)
+				WriteEvent(w, r->tid, events[i]);
+		}
+
+		uint32_t dropped = r->dropped.load(std::memory_order_relaxed);
+		if (last && dropped) {
+			Separate(w);
+			fprintf(w.file,
+					"{\"name\":\"dropped spans\",\"ph\":\"C\",\"pid\":1,"
+					"\"tid\":%d,\"ts\":%.3f,\"args\":{\"dropped\":%u}}",
+					(int)r->tid, (VSTFX_Trace::Now() - w.origin) / 1000.0,
+					dropped);
+		}
+	}
+	fflush(w.file);
+}
+
+void WriterLoop() {
+	Writer &w = State();
+	std::unique_lock<std::mutex> lock(w.mutex);
+	while (w.running) {
+		w.wake.wait_for(lock, std::chrono::milliseconds(TRACE_FLUSH_MS));
+		Drain(w, !w.running);
+	}
+}
+
+} // namespace
+
+// -------- Recording --------
+
+int64_t VSTFX_Trace::Now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+void VSTFX_Trace::Record(const VSTFX_TraceEvent &event) {
+	static thread_local ThreadRing *ring = NULL;
+	if (!ring) ring = Claim(event.cat);
+	if (!ring) return;
+	if (!ring->ring.push(event))
+		ring->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+// -------- Control --------
+
+bool VSTFX_Trace::Start(const char *path) {
+	std::lock_guard<std::mutex> lock(State().control);
+	return StartLocked(path);
+}
+
+void VSTFX_Trace::Stop() {
+	std::lock_guard<std::mutex> lock(State().control);
+	StopLocked();
+}
+
+void VSTFX_Trace::Acquire() {
+	Writer &w = State();
+	std::lock_guard<std::mutex> lock(w.control);
+	const char *path = getenv("VSTFX_TRACE");
+	if (w.users++ == 0 && path && *path) StartLocked(path);
+}
+
+void VSTFX_Trace::Release() {
+	Writer &w = State();
+	std::lock_guard<std::mutex> lock(w.control);
+	if (--w.users == 0) StopLocked();
+}
+
+bool VSTFX_Trace::StartLocked(const char *path) {
+	Writer &w = State();
+	if (w.running) return true;
+
+	// instances come and go during a session, they all go into one file
+	bool resume = w.end >= 0 && w.path == path;
+	w.file = fopen(path, resume ? "r+" : "w");
+	if (!w.file) return false;
+	if (resume) {
+		fseek(w.file, w.end, SEEK_SET);
+	} else {
+		fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", w.file);
+		w.path = path;
+		w.first = true;
+		w.origin = Now();
+	}
+
+	// here rather than on some thread's first span
+	if (!w.rings.load(std::memory_order_relaxed))
+		w.rings.store(new ThreadRing[TRACE_MAX_THREADS],
+					  std::memory_order_release);
+
+	// spans left over from a previous trace
+	ThreadRing *rings = w.rings.load(std::memory_order_relaxed);
+	for (int32_t i = 0, n = Claimed(w); i < n; i++) {
+		rings[i].ring.discard();
+		rings[i].dropped.store(0, std::memory_order_relaxed);
+		if (!resume) rings[i].named = false;
+	}
+
+	// the previous writer thread, if any, was joined by StopLocked()
+	w.running = true;
+	w.thread = std::thread(WriterLoop);
+	enabled.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void VSTFX_Trace::StopLocked() {
+	Writer &w = State();
+	if (!w.running) return;
+	enabled.store(false, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(w.mutex);
+		w.running = false;
+	}
+
+	// the writer drains once more on its way out
+	w.wake.notify_one();
+	w.thread.join();
+
+	w.end = ftell(w.file);
+	fputs("\n]}\n", w.file);
+	fclose(w.file);
+	w.file = NULL;
+}
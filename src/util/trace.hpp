@@ -0,0 +1,100 @@
+#ifndef VSTFX_TRACE_H
+#define VSTFX_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief One finished span. Names are string literals, the writer reads
+ * them long after the span ended.
+ */
+struct VSTFX_TraceEvent {
+	const char *cat, *name;
+	const char *arg_name; // NULL without an argument
+	int64_t arg;
+	int64_t start, duration; // ns
+};
+
+/*!
+ * \brief Records timing spans of every thread into a Chrome trace JSON
+ * file, which chrome://tracing and ui.perfetto.dev both open.
+ *
+ * Each thread records into a lock-free ring of its own, claimed by its
+ * first span from a pool Start() allocates, so not even a thread's first
+ * span allocates or locks. A background thread streams the rings to
+ * disk, so a span never waits on the file. A full ring drops spans and
+ * the trace says how many, threads beyond the pool drop all of theirs.
+ *
+ * Setting VSTFX_TRACE to a file path traces while the module has
+ * instances. Instances created after the last one closed add to the same
+ * file.
+ */
+class VSTFX_Trace {
+public:
+	/*!
+	 * \brief Starts tracing into `path`, false if it cannot be written.
+	 */
+	static bool Start(const char *path);
+
+	/*!
+	 * \brief Stops tracing and finishes the file.
+	 */
+	static void Stop();
+
+	// the one branch a span costs while tracing is off
+	static bool On() { return enabled.load(std::memory_order_relaxed); }
+
+	static int64_t Now();
+
+	// appends to the calling thread's ring
+	static void Record(const VSTFX_TraceEvent &event);
+
+	/*!
+	 * \brief Called by every instance when created and destroyed, traces
+	 * while instances exist if VSTFX_TRACE is set.
+	 */
+	static void Acquire();
+	static void Release();
+
+private:
+	// with the control lock held
+	static bool StartLocked(const char *path);
+	static void StopLocked();
+
+	static std::atomic<bool> enabled;
+};
+
+/*!
+ * \brief Records the time between its construction and destruction.
+ */
+class VSTFX_TraceSpan {
+public:
+	VSTFX_TraceSpan(const char *cat, const char *name,
+					const char *arg_name = NULL, int64_t arg = 0) {
+		event.name = NULL;
+		if (VSTFX_Trace::On()) {
+			event.cat = cat;
+			event.name = name;
+			event.arg_name = arg_name;
+			event.arg = arg;
+			event.start = VSTFX_Trace::Now();
+		}
+	}
+
+	~VSTFX_TraceSpan() {
+		if (event.name) {
+			event.duration = VSTFX_Trace::Now() - event.start;
+			VSTFX_Trace::Record(event);
+		}
+	}
+
+	VSTFX_TraceSpan(const VSTFX_TraceSpan &) = delete;
+	VSTFX_TraceSpan &operator=(const VSTFX_TraceSpan &) = delete;
+
+private:
+	// only the name is set while tracing is off
+	VSTFX_TraceEvent event;
+};
+
+#endif
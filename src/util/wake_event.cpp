@@ -0,0 +1,39 @@
+#include "wake_event.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#endif
+
+#ifdef _WIN32
+
+VSTFX_WakeEvent::VSTFX_WakeEvent() {
+	semaphore = CreateSemaphoreW(NULL, 0, 1, NULL);
+}
+
+VSTFX_WakeEvent::~VSTFX_WakeEvent() {
+	if (semaphore) CloseHandle(semaphore);
+}
+
+void VSTFX_WakeEvent::wakeWaiter() { ReleaseSemaphore(semaphore, 1, NULL); }
+
+void VSTFX_WakeEvent::sleep() {
+	WaitForSingleObject(semaphore, INFINITE);
+}
+
+#else
+
+VSTFX_WakeEvent::VSTFX_WakeEvent() { sem_init(&semaphore, 0, 0); }
+
+VSTFX_WakeEvent::~VSTFX_WakeEvent() { sem_destroy(&semaphore); }
+
+// sem_post is async-signal-safe, it takes no lock
+void VSTFX_WakeEvent::wakeWaiter() { sem_post(&semaphore); }
+
+void VSTFX_WakeEvent::sleep() {
+	while (sem_wait(&semaphore) != 0 && errno == EINTR) {
+	}
+}
+
+#endif
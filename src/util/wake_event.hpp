@@ -0,0 +1,61 @@
+#ifndef VSTFX_WAKE_EVENT_H
+#define VSTFX_WAKE_EVENT_H
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <semaphore.h>
+#endif
+
+/*!
+ * \brief Parks a background thread until another thread has work for it.
+ *
+ * post() is meant for the audio thread: it never blocks, and while the
+ * waiter is awake it is a single atomic operation. Only when the waiter
+ * is asleep does it call into the OS to wake it. Posts made while the
+ * waiter is awake collapse into one, which the next wait() consumes
+ * without sleeping, so no post is ever lost.
+ *
+ * There is at most one waiting thread.
+ */
+class VSTFX_WakeEvent {
+public:
+	VSTFX_WakeEvent();
+	~VSTFX_WakeEvent();
+
+	VSTFX_WakeEvent(const VSTFX_WakeEvent &) = delete;
+	VSTFX_WakeEvent &operator=(const VSTFX_WakeEvent &) = delete;
+
+	void post() {
+		int32_t s = state.load(std::memory_order_relaxed);
+		do {
+			if (s == 1) return; // already posted
+		} while (!state.compare_exchange_weak(s, s + 1,
+											  std::memory_order_release,
+											  std::memory_order_relaxed));
+		if (s < 0) wakeWaiter();
+	}
+
+	// returns at once if posted since the last call, else sleeps until
+	// the next post()
+	void wait() {
+		if (state.fetch_sub(1, std::memory_order_acquire) == 1) return;
+		sleep();
+	}
+
+private:
+	void wakeWaiter();
+	void sleep();
+
+	// 1 posted, 0 neither, -1 the waiter is asleep
+	std::atomic<int32_t> state{0};
+
+#ifdef _WIN32
+	void *semaphore{NULL}; // HANDLE
+#else
+	sem_t semaphore;
+#endif
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "zero_pages.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+
+bool VSTFX_ZeroPages::allocate(size_t bytes) {
+	release();
+	if (bytes == 0) return true;
+
+	// committed pages read as zero and are backed on first touch
+	pages = VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT,
+						 PAGE_READWRITE);
+	if (!pages) return false;
+	length = bytes;
+	return true;
+}
+
+void VSTFX_ZeroPages::release() {
+	if (pages) VirtualFree(pages, 0, MEM_RELEASE);
+	pages = NULL;
+	length = 0;
+}
+
+#else
+
+bool VSTFX_ZeroPages::allocate(size_t bytes) {
+	release();
+	if (bytes == 0) return true;
+
+	void *view = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+					  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (view == MAP_FAILED) return false;
+	pages = view;
+	length = bytes;
+	return true;
+}
+
+void VSTFX_ZeroPages::release() {
+	if (pages) munmap(pages, length);
+	pages = NULL;
+	length = 0;
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef VSTFX_ZERO_PAGES_H
+#define VSTFX_ZERO_PAGES_H
+
+#include <cstddef>
+#include <utility>
+
+/*!
+ * \brief Zeroed memory straight from the OS, for large buffers that may
+ * never be used.
+ *
+ * Nothing is written at allocate(), pages are mapped in on first access,
+ * so a buffer costs memory only as far as it is touched. Unlike calloc,
+ * this does not depend on the allocator having handed out fresh pages.
+ */
+class VSTFX_ZeroPages {
+public:
+	VSTFX_ZeroPages() {}
+	~VSTFX_ZeroPages() { release(); }
+
+	VSTFX_ZeroPages(const VSTFX_ZeroPages &) = delete;
+	VSTFX_ZeroPages &operator=(const VSTFX_ZeroPages &) = delete;
+
+	// replaces the previous pages, false if the OS refused
+	bool allocate(size_t bytes);
+	void release();
+
+	void swap(VSTFX_ZeroPages &other) {
+		std::swap(pages, other.pages);
+		std::swap(length, other.length);
+	}
+
+	void *data() const { return pages; }
+	size_t size() const { return length; }
+
+private:
+	void *pages{NULL};
+	size_t length{0};
+};
+
+#endif
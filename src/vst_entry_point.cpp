@@ -4,6 +4,10 @@ extern "C" {
 Vst::AEffect *VSTPluginMain(Vst::AudioMasterCallbackFunc audioMaster) {
 	auto plugin_instance = new VSTFX(audioMaster);
 	if (!plugin_instance) return NULL;
+	if (!plugin_instance->isValid()) {
+		delete plugin_instance;
+		return NULL;
+	}
 	return plugin_instance->getPluginInstance();
 }
 }
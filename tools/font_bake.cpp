@@ -0,0 +1,93 @@
+// Rasterizes the editor font atlas for every supported UI scale and writes
+// it out as C++ source, so the plugin never builds an atlas at runtime.
+//
+// usage: font_bake <output.cpp>
+
+#include "imgui.h"
+#include <cstdio>
+#include <cstring>
+
+static const float scales[] = {1.0f, 1.5f, 2.0f};
+
+// float literal that is still valid C++ for whole numbers
+static const char *Float(float v) {
+	static char buf[4][32];
+	static int n = 0;
+	char *out = buf[n++ & 3];
+	snprintf(out, 32, "%.9g", v);
+	if (!strpbrk(out, ".e")) strcat(out, ".0");
+	strcat(out, "f");
+	return out;
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s <output.cpp>\n", argv[0]);
+		return 1;
+	}
+
+	ImFontAtlas atlas;
+	// the editor does not use software cursors or textured lines
+	atlas.Flags |= ImFontAtlasFlags_NoMouseCursors |
+				   ImFontAtlasFlags_NoBakedLines |
+				   ImFontAtlasFlags_NoPowerOfTwoHeight;
+
+	for (float scale : scales) {
+		ImFontConfig cfg;
+		cfg.SizePixels = 13.0f * scale;
+		atlas.AddFontDefault(&cfg);
+	}
+
+	unsigned char *pixels;
+	int width, height;
+	atlas.GetTexDataAsAlpha8(&pixels, &width, &height);
+
+	FILE *f = fopen(argv[1], "w");
+	if (!f) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	fprintf(f, "#include \"font_atlas.h\"\n\n");
+
+	fprintf(f, "const unsigned char FONT_ATLAS[] = {");
+	for (int i = 0; i < width * height; i++)
+		fprintf(f, "%s%d,", (i % 32) ? "" : "\n", pixels[i]);
+	fprintf(f, "\n};\n\n");
+
+	fprintf(f, "const unsigned int FONT_ATLAS_WIDTH = %d;\n", width);
+	fprintf(f, "const unsigned int FONT_ATLAS_HEIGHT = %d;\n", height);
+	fprintf(f, "const float FONT_ATLAS_WHITE_U = %s;\n",
+			Float(atlas.TexUvWhitePixel.x));
+	fprintf(f, "const float FONT_ATLAS_WHITE_V = %s;\n\n",
+			Float(atlas.TexUvWhitePixel.y));
+
+	fprintf(f, "const VSTFX_BakedFont FONT_ATLAS_FONTS[] = {\n");
+	int first = 0;
+	for (int i = 0; i < atlas.Fonts.Size; i++) {
+		ImFont *font = atlas.Fonts[i];
+		fprintf(f, "\t{%s, %s, %s, %s, %d, %d, %d},\n", Float(scales[i]),
+				Float(font->FontSize), Float(font->Ascent),
+				Float(font->Descent), (int)font->EllipsisChar, first,
+				font->Glyphs.Size);
+		first += font->Glyphs.Size;
+	}
+	fprintf(f, "};\n\n");
+	fprintf(f, "const unsigned int FONT_ATLAS_FONT_COUNT = %d;\n\n",
+			atlas.Fonts.Size);
+
+	fprintf(f, "const VSTFX_BakedGlyph FONT_ATLAS_GLYPHS[] = {\n");
+	for (int i = 0; i < atlas.Fonts.Size; i++) {
+		for (const ImFontGlyph &g : atlas.Fonts[i]->Glyphs) {
+			fprintf(f, "\t{%u, %s, %s, %s, ", (unsigned int)g.Codepoint,
+					Float(g.AdvanceX), Float(g.X0), Float(g.Y0));
+			fprintf(f, "%s, %s, %s, %s, ", Float(g.X1), Float(g.Y1),
+					Float(g.U0), Float(g.V0));
+			fprintf(f, "%s, %s},\n", Float(g.U1), Float(g.V1));
+		}
+	}
+	fprintf(f, "};\n");
+
+	fclose(f);
+	return 0;
+}
@@ -0,0 +1,252 @@
+// Renders a bundled MIDI arrangement through VSTPluginMain without a host
+// or a display, and reports how long it took. It is the training run of
+// the PGO build and the measure of whether LTO and PGO pay off.
+//
+// usage: vstfx_render [--seconds 30] [--runs 3] [--json out.json]
+//                     [--baseline in.json] [--quality realtime|offline]
+//
+// Each run renders the arrangement on a fresh instance, the fastest one
+// is reported.
+// With --baseline, the result of another build (written with --json) is
+// compared and the speedup printed.
+// With --quality offline, the host reports an offline render, so the
+// plugin runs its offline kernels.
+
+#include "core_parameters.hpp"
+#include "midi.hpp"
+#include "vst.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" Vst::AEffect *VSTPluginMain(Vst::AudioMasterCallbackFunc);
+
+#define RATE 48000.0f
+#define BLOCK 256
+
+// 120 bpm, sixteenth notes, events fall on half steps
+#define STEP_FRAMES 6000
+#define TICK_FRAMES (STEP_FRAMES / 2)
+#define STEPS_PER_BAR 16
+
+static bool offline = false;
+
+static intptr_t VSTCALLBACK Host(Vst::AEffect *effect,
+								 Vst::VstOpcodeToHost opcode, int32_t index,
+								 intptr_t value, void *ptr, float opt) {
+	if (opcode == Vst::audioMasterGetCurrentProcessLevel) {
+		return offline ? Vst::kVstProcessLevelOffline
+					   : Vst::kVstProcessLevelRealtime;
+	}
+	return 0;
+}
+
+// -------- Arrangement --------
+
+// four bars that loop: pad chords, bass, a sixteenth arpeggio, and the
+// modwheel and pitch bend a player would add
+static const uint8_t chords[4][4] = {
+	{57, 60, 64, 67}, {53, 57, 60, 64}, {48, 52, 55, 59}, {55, 59, 62, 65}};
+static const uint8_t bass[4] = {33, 29, 36, 31};
+
+// what each pass over the arrangement sounds like, so the training covers
+// every waveform, filter and voice mode
+struct Pass {
+	float waveform, filter, unison, voice_mode;
+};
+static const Pass passes[] = {
+	{0.0f, 0.0f, 0.0f, 0.0f},	// sine, unfiltered
+	{1.0f, 0.5f, 0.5f, 0.0f},	// saw, SVF, 8-voice unison
+	{1.0f, 1.0f, 1.0f, 0.0f},	// saw, ladder, 16-voice unison
+	{1.0f, 0.5f, 0.25f, 1.0f}, // legato lead
+};
+
+struct Sequencer {
+	Vst::VstMidiEvent midi[Vst::VstEvents::MAX_EVENTS];
+	Vst::VstEvents events;
+	int32_t count{0};
+
+	void add(int32_t delta, uint8_t status, uint8_t d1, uint8_t d2) {
+		if (count == Vst::VstEvents::MAX_EVENTS) return;
+		Vst::VstMidiEvent &ev = midi[count];
+		memset(&ev, 0, sizeof(ev));
+		ev.type = Vst::kVstMidiType;
+		ev.byteSize = sizeof(ev);
+		ev.deltaFrames = delta;
+		ev.midiData = status | (d1 << 8) | (d2 << 16);
+		events.events[count++] = &ev;
+		events.numEvents = count;
+	}
+
+	// the events of one half step
+	void tick(int64_t t, int32_t delta) {
+		int64_t n = t / 2;
+		int32_t bar = (int32_t)(n / STEPS_PER_BAR) % 4;
+		int32_t s = (int32_t)(n % STEPS_PER_BAR);
+		int32_t prev = (bar + 3) % 4;
+		int32_t arp = chords[bar][s % 4] + 12 * (1 + s / 8);
+
+		if (t & 1) {
+			add(delta, MIDI_NOTE_OFF, arp, 0);
+			return;
+		}
+
+		if (s == 0) {
+			for (int32_t i = 0; i < 4; i++) {
+				add(delta, MIDI_NOTE_OFF, chords[prev][i], 0);
+				add(delta, MIDI_NOTE_ON, chords[bar][i], 70 + 10 * i);
+			}
+			add(delta, MIDI_NOTE_OFF, bass[prev], 0);
+			add(delta, MIDI_NOTE_ON, bass[bar], 110);
+		}
+
+		add(delta, MIDI_NOTE_ON, arp, 60 + (s * 7) % 60);
+
+		add(delta, MIDI_CC, MIDI_CC_MODWHEEL, (s * 8) & 0x7f);
+		int32_t bend = 8192 + (int32_t)(2000.0f * sinf(n * 0.3f));
+		add(delta, MIDI_PITCH_BEND, bend & 0x7f, (bend >> 7) & 0x7f);
+	}
+};
+
+// -------- Result files --------
+
+static bool WriteJson(const char *path, double us) {
+	FILE *f = fopen(path, "w");
+	if (!f) return false;
+	fprintf(f, "{\n  \"us_per_block\": %.3f\n}\n", us);
+	fclose(f);
+	return true;
+}
+
+static bool ReadJson(const char *path, double *us) {
+	FILE *f = fopen(path, "r");
+	if (!f) return false;
+	char text[256] = {0};
+	fread(text, 1, sizeof(text) - 1, f);
+	fclose(f);
+
+	const char *p = strstr(text, "\"us_per_block\":");
+	if (!p) return false;
+	*us = strtod(p + strlen("\"us_per_block\":"), NULL);
+	return *us > 0.0;
+}
+
+// -------- Render --------
+
+// one run on a fresh instance, returns the time spent in the plugin
+static double Render(int64_t blocks, double *energy) {
+	Vst::AEffect *effect = VSTPluginMain(Host);
+	effect->dispatcher(effect, Vst::effSetSampleRate, 0, 0, NULL, RATE);
+	effect->dispatcher(effect, Vst::effMainsChanged, 0, 1, NULL, 0.0f);
+	effect->setParameter(effect, kDelayMix, 0.3f);
+	effect->setParameter(effect, kLfoDepth, 0.2f);
+	effect->setParameter(effect, kDetune, 0.4f);
+	effect->setParameter(effect, kSpread, 0.8f);
+
+	static float left[BLOCK], right[BLOCK];
+	float *outputs[2] = {left, right};
+
+	int64_t pass_blocks = blocks / 4 + 1;
+	int64_t next_tick = 0;
+	*energy = 0.0;
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (int64_t b = 0; b < blocks; b++) {
+		int64_t frame = b * BLOCK;
+
+		// each quarter of the render sounds different
+		if (b % pass_blocks == 0) {
+			const Pass &p = passes[b / pass_blocks];
+			effect->setParameter(effect, kWaveform, p.waveform);
+			effect->setParameter(effect, kFilterType, p.filter);
+			effect->setParameter(effect, kUnison, p.unison);
+			effect->setParameter(effect, kVoiceMode, p.voice_mode);
+		}
+
+		// automation, as a host sends it once per block
+		float sweep = 0.5f + 0.5f * sinf(frame * 1e-5f);
+		effect->setParameter(effect, kCutoff, sweep);
+		effect->setParameter(effect, kResonance, 0.6f * sweep);
+
+		Sequencer seq;
+		for (; next_tick * TICK_FRAMES < frame + BLOCK; next_tick++)
+			seq.tick(next_tick, (int32_t)(next_tick * TICK_FRAMES - frame));
+		if (seq.count) {
+			effect->dispatcher(effect, Vst::effProcessEvents, 0, 0,
+							   &seq.events, 0.0f);
+		}
+
+		effect->processReplacing(effect, NULL, outputs, BLOCK);
+		for (int32_t i = 0; i < BLOCK; i++)
+			*energy += left[i] * left[i] + right[i] * right[i];
+	}
+	double us = std::chrono::duration<double, std::micro>(
+					std::chrono::steady_clock::now() - t0)
+					.count();
+
+	effect->dispatcher(effect, Vst::effClose, 0, 0, NULL, 0.0f);
+	return us;
+}
+
+// -------- Main --------
+
+int main(int argc, char **argv) {
+	double seconds = 30.0;
+	int runs = 3;
+	const char *json = NULL, *baseline = NULL;
+	for (int i = 1; i < argc; i += 2) {
+		if (i + 1 == argc) {
+			fprintf(stderr, "%s needs a value\n", argv[i]);
+			return 2;
+		} else if (!strcmp(argv[i], "--seconds")) {
+			seconds = atof(argv[i + 1]);
+		} else if (!strcmp(argv[i], "--runs")) {
+			runs = atoi(argv[i + 1]);
+		} else if (!strcmp(argv[i], "--json")) {
+			json = argv[i + 1];
+		} else if (!strcmp(argv[i], "--baseline")) {
+			baseline = argv[i + 1];
+		} else if (!strcmp(argv[i], "--quality")) {
+			offline = !strcmp(argv[i + 1], "offline");
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 2;
+		}
+	}
+
+	int64_t blocks = (int64_t)(seconds * RATE / BLOCK);
+	if (blocks < 1 || runs < 1) {
+		fprintf(stderr, "nothing to render\n");
+		return 2;
+	}
+
+	// the best run, the others are the machine being busy
+	double us = 1e30, energy = 0.0;
+	for (int run = 0; run < runs; run++)
+		us = std::min(us, Render(blocks, &energy));
+
+	double per_block = us / blocks;
+	printf("rendered %.1f s in %.1f ms, %.1fx realtime, %.3f us per %d "
+		   "frame block (energy %.6g)\n",
+		   seconds, us / 1000.0, seconds * 1e6 / us, per_block, BLOCK,
+		   energy);
+
+	if (json && !WriteJson(json, per_block)) {
+		fprintf(stderr, "cannot write %s\n", json);
+		return 2;
+	}
+
+	if (baseline) {
+		double reference;
+		if (!ReadJson(baseline, &reference)) {
+			fprintf(stderr, "cannot read %s\n", baseline);
+			return 2;
+		}
+		printf("baseline %.3f us per block, speedup %.2fx\n", reference,
+			   reference / per_block);
+	}
+	return 0;
+}